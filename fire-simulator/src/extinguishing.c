@@ -0,0 +1,556 @@
+/*
+ * Simplified simulation of fire extinguishing
+ *
+ * v1.4
+ *
+ * Sequential reference code. Built with OpenMP (parallel_extinguishing.exe) the heat step,
+ * the residual and the team movement and cooling run on OMP_NUM_THREADS threads with the same
+ * results.
+ *
+ * (c) 2019 Arturo Gonzalez Escribano
+ */
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ppm_fire_file.h"
+
+
+/* Function to get wall time */
+double cp_Wtime() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + 1.0e-6 * tv.tv_usec;
+}
+
+#define RADIUS_TYPE_1 3
+#define RADIUS_TYPE_2_3 9
+#define THRESHOLD 0.1f
+
+/* Structure to store data of an extinguishing team: x, y, type, target */
+typedef ppm_team_t Team;
+
+/* Structure to store data of a fire focal point: x, y, start, heat, active (0 Not yet
+ * activated; 1 Active; 2 Deactivated by a team) */
+typedef ppm_focal_t FocalPoint;
+
+/* Macro function to simplify accessing with two coordinates to a flattened array */
+#define accessMat(arr, exp1, exp2) arr[(exp1) * columns + (exp2)]
+
+/*
+ * Function: Print usage line in stderr
+ */
+void show_usage(char *program_name) {
+    fprintf(stderr, "Usage: %s <config_file> | <command_line_args>\n", program_name);
+    fprintf(stderr, "\t<config_file> ::= -f <file_name> | -b <binary_file_name>\n");
+    fprintf(stderr,
+            "\t<command_line_args> ::= <rows> <columns> <maxIter> <numTeams> [ <teamX> <teamY> "
+            "<teamType> ... ] <numFocalPoints> [ <focalX> <focalY> <focalStart> <focalTemperature> "
+            "... ]\n");
+    fprintf(stderr, "\n");
+}
+
+#ifdef DEBUG
+/*
+ * Function: Print the current state of the simulation
+ */
+void print_status(int iteration, int rows, int columns, float *surface, int num_teams, Team *teams,
+                  int num_focal, FocalPoint *focal, float global_residual) {
+    /*
+     * You don't need to optimize this function, it is only for pretty printing and debugging
+     * purposes. It is not compiled in the production versions of the program. Thus, it is never
+     * used when measuring times in the leaderboard
+     */
+    int i, j;
+
+    printf("Iteration: %d\n", iteration);
+    printf("+");
+    for (j = 0; j < columns; j++) printf("---");
+    printf("+\n");
+    for (i = 0; i < rows; i++) {
+        printf("|");
+        for (j = 0; j < columns; j++) {
+            char symbol;
+            if (accessMat(surface, i, j) >= 1000)
+                symbol = '*';
+            else if (accessMat(surface, i, j) >= 100)
+                symbol = '0' + (int)(accessMat(surface, i, j) / 100);
+            else if (accessMat(surface, i, j) >= 50)
+                symbol = '+';
+            else if (accessMat(surface, i, j) >= 25)
+                symbol = '.';
+            else
+                symbol = '0';
+
+            int t;
+            int flag_team = 0;
+            for (t = 0; t < num_teams; t++)
+                if (teams[t].x == i && teams[t].y == j) {
+                    flag_team = 1;
+                    break;
+                }
+            if (flag_team)
+                printf("[%c]", symbol);
+            else {
+                int f;
+                int flag_focal = 0;
+                for (f = 0; f < num_focal; f++)
+                    if (focal[f].x == i && focal[f].y == j && focal[f].active == 1) {
+                        flag_focal = 1;
+                        break;
+                    }
+                if (flag_focal)
+                    printf("(%c)", symbol);
+                else
+                    printf(" %c ", symbol);
+            }
+        }
+        printf("|\n");
+    }
+    printf("+");
+    for (j = 0; j < columns; j++) printf("---");
+    printf("+\n");
+    printf("Global residual: %f\n\n", global_residual);
+}
+#endif
+
+/*
+ * Function: Read a binary scenario file (tools/generate_scenario.py), see ppm_fire_file.h
+ */
+void read_binary_config(char *file_name, int *rows, int *columns, int *max_iter, int *num_teams,
+                        Team **teams, int *num_focal, FocalPoint **focal) {
+    FILE *args = fopen(file_name, "rb");
+    char magic[sizeof(PPM_FIRE_MAGIC) - 1];
+    ppm_fire_scenario_t scenario;
+
+    if (args == NULL) {
+        fprintf(stderr, "-- Error in file: not found: %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    if (fread(magic, 1, sizeof(magic), args) != sizeof(magic) ||
+        memcmp(magic, PPM_FIRE_MAGIC, sizeof(magic)) != 0) {
+        fprintf(stderr, "-- Error in file: not a binary scenario file: %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    if (ppm_fire_read_binary(args, file_name, &scenario) != 0) exit(EXIT_FAILURE);
+    fclose(args);
+
+    *rows = scenario.rows;
+    *columns = scenario.columns;
+    *max_iter = scenario.max_iter;
+    *num_teams = scenario.num_teams;
+    *teams = scenario.teams;
+    *num_focal = scenario.num_focal;
+    *focal = scenario.focal;
+}
+
+/*
+ * MAIN PROGRAM
+ */
+int main(int argc, char *argv[]) {
+    int i, j, t;
+
+    // Simulation data
+    int rows, columns, max_iter;
+    float *surface, *surfaceCopy;
+    int num_teams, num_focal;
+    Team *teams;
+    FocalPoint *focal;
+
+    /* 1. Read simulation arguments */
+    /* 1.1. Check minimum number of arguments */
+    if (argc < 2) {
+        fprintf(stderr, "-- Error in arguments: No arguments\n");
+        show_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    int read_from_file = !strcmp(argv[1], "-f");
+    int read_from_binary = !strcmp(argv[1], "-b");
+    /* 1.2. Read configuration from file */
+    if (read_from_file) {
+        /* 1.2.1. Open file */
+        if (argc < 3) {
+            fprintf(stderr, "-- Error in arguments: file-name argument missing\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        FILE *args = fopen(argv[2], "r");
+        if (args == NULL) {
+            fprintf(stderr, "-- Error in file: not found: %s\n", argv[2]);
+            exit(EXIT_FAILURE);
+        }
+
+        /* 1.2.2. Read surface and maximum number of iterations */
+        int ok;
+        ok = fscanf(args, "%d %d %d", &rows, &columns, &max_iter);
+        if (ok != 3) {
+            fprintf(stderr, "-- Error in file: reading rows, columns, max_iter from file: %s\n",
+                    argv[2]);
+            exit(EXIT_FAILURE);
+        }
+
+        /* 1.2.3. Teams information */
+        ok = fscanf(args, "%d", &num_teams);
+        if (ok != 1) {
+            fprintf(stderr, "-- Error file, reading num_teams from file: %s\n", argv[2]);
+            exit(EXIT_FAILURE);
+        }
+        teams = (Team *)malloc(sizeof(Team) * (size_t)num_teams);
+        if (teams == NULL) {
+            fprintf(stderr, "-- Error allocating: %d teams\n", num_teams);
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < num_teams; i++) {
+            ok = fscanf(args, "%d %d %d", &teams[i].x, &teams[i].y, &teams[i].type);
+            if (ok != 3) {
+                fprintf(stderr, "-- Error in file: reading team %d from file: %s\n", i, argv[2]);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        /* 1.2.4. Focal points information */
+        ok = fscanf(args, "%d", &num_focal);
+        if (ok != 1) {
+            fprintf(stderr, "-- Error in file: reading num_focal from file: %s\n", argv[2]);
+            exit(EXIT_FAILURE);
+        }
+        focal = (FocalPoint *)malloc(sizeof(FocalPoint) * (size_t)num_focal);
+        if (focal == NULL) {
+            fprintf(stderr, "-- Error allocating: %d focal points\n", num_focal);
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < num_focal; i++) {
+            ok = fscanf(args, "%d %d %d %d", &focal[i].x, &focal[i].y, &focal[i].start,
+                        &focal[i].heat);
+            if (ok != 4) {
+                fprintf(stderr, "-- Error in file: reading focal point %d from file: %s\n", i,
+                        argv[2]);
+                exit(EXIT_FAILURE);
+            }
+            focal[i].active = 0;
+        }
+    }
+    /* 1.2b. Read configuration from a binary file (tools/generate_scenario.py) */
+    else if (read_from_binary) {
+        if (argc < 3) {
+            fprintf(stderr, "-- Error in arguments: file-name argument missing\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        read_binary_config(argv[2], &rows, &columns, &max_iter, &num_teams, &teams, &num_focal,
+                           &focal);
+    }
+    /* 1.3. Read configuration from arguments */
+    else {
+        /* 1.3.1. Check minimum number of arguments */
+        if (argc < 6) {
+            fprintf(stderr,
+                    "-- Error in arguments: not enough arguments when reading configuration from "
+                    "the command line\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+
+        /* 1.3.2. Surface and maximum number of iterations */
+        rows = atoi(argv[1]);
+        columns = atoi(argv[2]);
+        max_iter = atoi(argv[3]);
+
+        /* 1.3.3. Teams information */
+        num_teams = atoi(argv[4]);
+        teams = (Team *)malloc(sizeof(Team) * (size_t)num_teams);
+        if (teams == NULL) {
+            fprintf(stderr, "-- Error allocating: %d teams\n", num_teams);
+            exit(EXIT_FAILURE);
+        }
+        if (argc < num_teams * 3 + 5) {
+            fprintf(stderr, "-- Error in arguments: not enough arguments for %d teams\n",
+                    num_teams);
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < num_teams; i++) {
+            teams[i].x = atoi(argv[5 + i * 3]);
+            teams[i].y = atoi(argv[6 + i * 3]);
+            teams[i].type = atoi(argv[7 + i * 3]);
+        }
+
+        /* 1.3.4. Focal points information */
+        int focal_args = 5 + i * 3;
+        if (argc < focal_args + 1) {
+            fprintf(stderr,
+                    "-- Error in arguments: not enough arguments for the number of focal points\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        num_focal = atoi(argv[focal_args]);
+        focal = (FocalPoint *)malloc(sizeof(FocalPoint) * (size_t)num_focal);
+        if (teams == NULL) {
+            fprintf(stderr, "-- Error allocating: %d focal points\n", num_focal);
+            exit(EXIT_FAILURE);
+        }
+        if (argc < focal_args + 1 + num_focal * 4) {
+            fprintf(stderr, "-- Error in arguments: not enough arguments for %d focal points\n",
+                    num_focal);
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < num_focal; i++) {
+            focal[i].x = atoi(argv[focal_args + i * 4 + 1]);
+            focal[i].y = atoi(argv[focal_args + i * 4 + 2]);
+            focal[i].start = atoi(argv[focal_args + i * 4 + 3]);
+            focal[i].heat = atoi(argv[focal_args + i * 4 + 4]);
+            focal[i].active = 0;
+        }
+
+        /* 1.3.5. Sanity check: No extra arguments at the end of line */
+        if (argc > focal_args + i * 4 + 1) {
+            fprintf(stderr,
+                    "-- Error in arguments: extra arguments at the end of the command line\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+#ifdef DEBUG
+    /* 1.4. Print arguments */
+    printf("Arguments, Rows: %d, Columns: %d, max_iter: %d, threshold: %f\n", rows, columns,
+           max_iter, THRESHOLD);
+    printf("Arguments, Teams: %d, Focal points: %d\n", num_teams, num_focal);
+    for (i = 0; i < num_teams; i++) {
+        printf("\tTeam %d, position (%d,%d), type: %d\n", i, teams[i].x, teams[i].y, teams[i].type);
+    }
+    for (i = 0; i < num_focal; i++) {
+        printf("\tFocal_point %d, position (%d,%d), start time: %d, temperature: %d\n", i,
+               focal[i].x, focal[i].y, focal[i].start, focal[i].heat);
+    }
+    printf("\nLEGEND:\n");
+    printf("\t( ) : Focal point\n");
+    printf("\t[ ] : Team position\n");
+    printf("\t0-9 : Temperature value in hundreds of degrees\n");
+    printf("\t*   : Temperature equal or higher than 1000 degrees\n\n");
+#endif  // DEBUG
+
+    /* 2. Start global timer */
+    double ttotal = cp_Wtime();
+
+    /*
+     *
+     * START HERE: DO NOT CHANGE THE CODE ABOVE THIS POINT
+     *
+     */
+
+    /* 3. Initialize surface */
+    surface = (float *)malloc(sizeof(float) * (size_t)rows * (size_t)columns);
+    surfaceCopy = (float *)malloc(sizeof(float) * (size_t)rows * (size_t)columns);
+    if (surface == NULL || surfaceCopy == NULL) {
+        fprintf(stderr, "-- Error allocating: surface structures\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < rows; i++)
+        for (j = 0; j < columns; j++) {
+            accessMat(surface, i, j) = 0.0;
+            accessMat(surfaceCopy, i, j) = 0.0;
+        }
+
+    /* 4. Simulation */
+    int iter;
+    int flag_stability = 0;
+    for (iter = 0; iter < max_iter && !flag_stability; iter++) {
+        /* 4.1. Activate focal points */
+        int num_deactivated = 0;
+        for (i = 0; i < num_focal; i++) {
+            if (focal[i].start == iter) {
+                focal[i].active = 1;
+            }
+            // Count focal points already deactivated by a team
+            if (focal[i].active == 2) num_deactivated++;
+        }
+
+        /* 4.2. Propagate heat (10 steps per each team movement) */
+        float global_residual = 0.0f;
+        int step;
+        for (step = 0; step < 10; step++) {
+            /* 4.2.1. Update heat on active focal points */
+            for (i = 0; i < num_focal; i++) {
+                if (focal[i].active != 1) continue;
+                int x = focal[i].x;
+                int y = focal[i].y;
+                if (x < 0 || x > rows - 1 || y < 0 || y > columns - 1) continue;
+                accessMat(surface, x, y) = focal[i].heat;
+            }
+
+            /* 4.2.2. Copy values of the surface in ancillary structure (including borders) */
+#pragma omp parallel for private(j)
+            for (i = 0; i < rows; i++)
+                for (j = 0; j < columns; j++)
+                    accessMat(surfaceCopy, i, j) = accessMat(surface, i, j);
+
+            /* 4.2.3. Update surface values (skip borders) */
+#pragma omp parallel for private(j)
+            for (i = 1; i < rows - 1; i++)
+                for (j = 1; j < columns - 1; j++)
+                    accessMat(surface, i, j) =
+                        (accessMat(surfaceCopy, i - 1, j) + accessMat(surfaceCopy, i + 1, j) +
+                         accessMat(surfaceCopy, i, j - 1) + accessMat(surfaceCopy, i, j + 1)) /
+                        4.0f;
+
+            /* 4.2.4. Compute the maximum residual difference (absolute value) of this step */
+            float residual = 0.0f;
+#pragma omp parallel for private(j) reduction(max : residual)
+            for (i = 1; i < rows - 1; i++)
+                for (j = 1; j < columns - 1; j++) {
+                    float diff = fabs(accessMat(surface, i, j) - accessMat(surfaceCopy, i, j));
+                    if (diff > residual) residual = diff;
+                }
+            global_residual = residual;
+        }
+
+        /* If the global residual is lower than THRESHOLD, we have reached enough stability, stop
+         * simulation at the end of this iteration */
+        if (num_deactivated == num_focal && global_residual < THRESHOLD) flag_stability = 1;
+
+        /* 4.3. Move teams */
+        /* Every team only reads the focal points and writes itself */
+#pragma omp parallel for private(j)
+        for (t = 0; t < num_teams; t++) {
+            /* 4.3.1. Choose nearest focal point */
+            float distance = FLT_MAX;
+            int target = -1;
+            for (j = 0; j < num_focal; j++) {
+                if (focal[j].active != 1) continue;  // Skip non-active focal points
+                float dx = focal[j].x - teams[t].x;
+                float dy = focal[j].y - teams[t].y;
+                float local_distance = sqrtf(dx * dx + dy * dy);
+                if (local_distance < distance) {
+                    distance = local_distance;
+                    target = j;
+                }
+            }
+            /* 4.3.2. Annotate target for the next stage */
+            teams[t].target = target;
+
+            /* 4.3.3. No active focal point to choose, no movement */
+            if (target == -1) continue;
+
+            /* 4.3.4. Move in the focal point direction */
+            if (teams[t].type == 1) {
+                // Type 1: Can move in diagonal
+                if (focal[target].x < teams[t].x) teams[t].x--;
+                if (focal[target].x > teams[t].x) teams[t].x++;
+                if (focal[target].y < teams[t].y) teams[t].y--;
+                if (focal[target].y > teams[t].y) teams[t].y++;
+            } else if (teams[t].type == 2) {
+                // Type 2: First in horizontal direction, then in vertical direction
+                if (focal[target].y < teams[t].y)
+                    teams[t].y--;
+                else if (focal[target].y > teams[t].y)
+                    teams[t].y++;
+                else if (focal[target].x < teams[t].x)
+                    teams[t].x--;
+                else if (focal[target].x > teams[t].x)
+                    teams[t].x++;
+            } else {
+                // Type 3: First in vertical direction, then in horizontal direction
+                if (focal[target].x < teams[t].x)
+                    teams[t].x--;
+                else if (focal[target].x > teams[t].x)
+                    teams[t].x++;
+                else if (focal[target].y < teams[t].y)
+                    teams[t].y--;
+                else if (focal[target].y > teams[t].y)
+                    teams[t].y++;
+            }
+        }
+
+        /* 4.4. Team actions */
+        /* 4.4.1. Deactivate the target focal point when it is reached */
+        for (t = 0; t < num_teams; t++) {
+            int target = teams[t].target;
+            if (target != -1 && focal[target].x == teams[t].x && focal[target].y == teams[t].y &&
+                focal[target].active == 1)
+                focal[target].active = 2;
+        }
+
+        /* 4.4.2. Reduce heat in a circle around every team. Circles overlap, so every thread
+         * cools only the rows of its own band, for all teams in order: no two threads write the
+         * same cell, and a cell is scaled as many times as in the sequential code */
+#pragma omp parallel private(i, j, t)
+        {
+#ifdef _OPENMP
+            int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+            int threads = 1, thread = 0;
+#endif
+            int band_begin = 1 + (int)((long)(rows - 2) * thread / threads);
+            int band_end = 1 + (int)((long)(rows - 2) * (thread + 1) / threads);
+
+            for (t = 0; t < num_teams; t++) {
+                int radius;
+                // Influence area of fixed radius depending on type
+                if (teams[t].type == 1)
+                    radius = RADIUS_TYPE_1;
+                else
+                    radius = RADIUS_TYPE_2_3;
+                int first = teams[t].x - radius, last = teams[t].x + radius;
+                if (first < band_begin) first = band_begin;
+                if (last > band_end - 1) last = band_end - 1;
+                for (i = first; i <= last; i++) {
+                    for (j = teams[t].y - radius; j <= teams[t].y + radius; j++) {
+                        if (j < 1 || j >= columns - 1) continue;  // Out of the heated surface
+                        float dx = teams[t].x - i;
+                        float dy = teams[t].y - j;
+                        float distance = sqrtf(dx * dx + dy * dy);
+                        if (distance <= radius) {
+                            accessMat(surface, i, j) =
+                                accessMat(surface, i, j) * (1 - 0.25);  // Team efficiency factor
+                        }
+                    }
+                }
+            }
+        }
+
+#ifdef DEBUG
+        /* 4.5. DEBUG: Print the current state of the simulation at the end of each iteration */
+        print_status(iter, rows, columns, surface, num_teams, teams, num_focal, focal,
+                     global_residual);
+#endif  // DEBUG
+    }
+
+    /*
+     *
+     * STOP HERE: DO NOT CHANGE THE CODE BELOW THIS POINT
+     *
+     */
+
+    /* 5. Stop global time */
+    ttotal = cp_Wtime() - ttotal;
+
+    /* 6. Output for leaderboard */
+    printf("\n");
+    /* 6.1. Total computation time */
+    printf("Time: %lf\n", ttotal);
+    /* 6.2. Results: Number of iterations, residual heat on the focal points */
+    printf("Result: %d", iter);
+    for (i = 0; i < num_focal; i++) {
+        int x = focal[i].x;
+        int y = focal[i].y;
+        if (x < 0 || x > rows - 1 || y < 0 || y > columns - 1) continue;
+        printf(" %.6f", accessMat(surface, x, y));
+    }
+    printf("\n");
+
+    /* 7. Free resources */
+    free(teams);
+    free(focal);
+    free(surface);
+    free(surfaceCopy);
+
+    /* 8. End */
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * Ensemble of fire extinguishing scenarios in one MPI job
+ *
+ * The scenarios are the files of a directory (sorted by name) or those listed in a manifest,
+ * one path per line relative to the manifest, where blank lines and lines starting with '#'
+ * are skipped. Scenarios can be in the text "-f" or the binary "-b" format of
+ * mpi_extinguishingQ.3.c (see ../../libppm/ppm_fire_file.h), told apart by ppm_fire_read().
+ *
+ * MPI_COMM_WORLD is split in groups of consecutive ranks (the last one may be smaller) and
+ * every scenario is simulated whole by one group, see ../../libppm/ppm_fire.h. The
+ * group size follows the grids: a rank per FIRE_CELLS_PER_RANK cells of the largest scenario,
+ * but never more ranks than the rows of the smallest one, unless ranks_per_group is given.
+ * Scenarios are handed out largest first (rows x columns x max_iter) from a work queue: a
+ * counter on rank 0 that the group roots increment with MPI_Fetch_and_op, so a group that is
+ * done early takes the next scenario instead of waiting for a static share. Each group reuses
+ * one slab, and its surface memory, for all of its scenarios.
+ *
+ * The "Result:" line of every scenario, as printed by the single-scenario simulator, is
+ * written to 'output' (stdout when missing or "-") in the order of the listing, prefixed by
+ * the scenario path. Rank 0 then prints the queue statistics:
+ *
+ *   scenarios/sweep_03.txt: Result: 301 1.042219 10.347036 28.453236 0.296538
+ *   Ensemble: scenarios=40 groups=4 ranks_per_group=3 makespan=2.3812 s
+ *
+ * The halo exchange strategy of the groups is chosen with PPM_HALO, as for the simulator.
+ *
+ * Usage: mpirun -np P fire_ensemble.exe <manifest|directory> [output] [ranks_per_group]
+ */
+#include <dirent.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "ppm_fire.h"
+#include "ppm_instr.h"
+#include "ppm_report.h"
+
+/* Surface cells worth one rank of a group */
+#define FIRE_CELLS_PER_RANK (256 * 256)
+
+#define PATH_LENGTH 4096
+
+/* Paths of the scenarios, packed one after the other with their '\0' */
+typedef struct {
+    char *text;
+    int length, capacity;
+    int count;
+} path_list_t;
+
+static int add_path(path_list_t *list, const char *dir, const char *name) {
+    char path[PATH_LENGTH];
+    int length;
+    char *grown;
+
+    if (dir != NULL && name[0] != '/')
+        length = snprintf(path, sizeof(path), "%s/%s", dir, name);
+    else
+        length = snprintf(path, sizeof(path), "%s", name);
+    if (length >= PATH_LENGTH) {
+        fprintf(stderr, "-- Error in ensemble: path too long: %s\n", name);
+        return -1;
+    }
+
+    if (list->length + length + 1 > list->capacity) {
+        list->capacity = 2 * (list->length + length + 1);
+        grown = (char *)realloc(list->text, list->capacity);
+        if (grown == NULL) {
+            fprintf(stderr, "-- Error allocating: ensemble paths\n");
+            return -1;
+        }
+        list->text = grown;
+    }
+    memcpy(list->text + list->length, path, length + 1);
+    list->length += length + 1;
+    list->count++;
+    return 0;
+}
+
+static int by_name(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* Regular files of 'dir', skipping hidden ones, sorted by name */
+static int read_directory(const char *dir, path_list_t *list) {
+    DIR *handle = opendir(dir);
+    struct dirent *entry;
+    struct stat info;
+    char path[PATH_LENGTH], **names = NULL, **grown;
+    int count = 0, capacity = 0, i, status = 0;
+
+    if (handle == NULL) {
+        fprintf(stderr, "-- Error in ensemble: cannot open directory: %s\n", dir);
+        return -1;
+    }
+    while ((entry = readdir(handle)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+
+        if (count == capacity) {
+            capacity = capacity == 0 ? 64 : 2 * capacity;
+            grown = (char **)realloc(names, sizeof(char *) * capacity);
+            if (grown == NULL) {
+                fprintf(stderr, "-- Error allocating: ensemble paths\n");
+                status = -1;
+                break;
+            }
+            names = grown;
+        }
+        if ((names[count] = strdup(entry->d_name)) == NULL) {
+            status = -1;
+            break;
+        }
+        count++;
+    }
+    closedir(handle);
+
+    if (status == 0) qsort(names, count, sizeof(char *), by_name);
+    for (i = 0; i < count; i++) {
+        if (status == 0) status = add_path(list, dir, names[i]);
+        free(names[i]);
+    }
+    free(names);
+    return status;
+}
+
+/* Paths listed in 'manifest', relative to its directory */
+static int read_manifest(const char *manifest, path_list_t *list) {
+    FILE *file = fopen(manifest, "r");
+    char line[PATH_LENGTH], dir[PATH_LENGTH], *text, *end, *slash;
+
+    if (file == NULL) {
+        fprintf(stderr, "-- Error in ensemble: not found: %s\n", manifest);
+        return -1;
+    }
+    snprintf(dir, sizeof(dir), "%s", manifest);
+    slash = strrchr(dir, '/');
+    if (slash != NULL)
+        *slash = '\0';
+    else
+        strcpy(dir, ".");
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        end = text + strlen(text);
+        while (end > text && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' ||
+                              end[-1] == '\t'))
+            *--end = '\0';
+        if (*text == '#' || *text == '\0') continue;
+        if (add_path(list, dir, text) != 0) {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+typedef struct {
+    double cost;
+    int index;
+} ranked_scenario_t;
+
+/* Decreasing cost, ties in listing order */
+static int by_decreasing_cost(const void *a, const void *b) {
+    const ranked_scenario_t *x = a, *y = b;
+
+    if (x->cost != y->cost) return x->cost < y->cost ? 1 : -1;
+    return x->index - y->index;
+}
+
+/* "<path>: Result: <iterations> <heat of every focal point inside the surface>", as the last
+ * output of the simulator. Returns a malloc'ed line */
+static char *result_line(const char *path, const ppm_fire_scenario_t *scenario,
+                         const ppm_fire_result_t *result, const float *surface) {
+    size_t capacity = strlen(path) + 64 + 64 * (size_t)scenario->num_focal, length;
+    char *line = (char *)malloc(capacity);
+    int i, x, y;
+
+    if (line == NULL) return NULL;
+    length = snprintf(line, capacity, "%s: Result: %d", path, result->iterations);
+    for (i = 0; i < scenario->num_focal; i++) {
+        x = scenario->focal[i].x;
+        y = scenario->focal[i].y;
+        if (x < 0 || x > scenario->rows - 1 || y < 0 || y > scenario->columns - 1) continue;
+        length += snprintf(line + length, capacity - length, " %.6f",
+                           surface[(size_t)x * scenario->columns + y]);
+    }
+    return line;
+}
+
+int main(int argc, char **argv) {
+    int rank, size, ranks_per_group = 0, groups, group, group_rank, count = 0, s, i;
+    int largest_rows = 0, largest_columns = 0, min_rows = 0, next, one = 1, *order, *counter;
+    int total_iterations = 0;
+    size_t max_cells = 0;
+    char **paths, **lines;
+    double flops = 0.0, bytes = 0.0, start, group_time, ensemble_time;
+    float max_residual = 0.0f, *fullSurface = NULL;
+    struct stat listing;
+    path_list_t list = {NULL, 0, 0, 0};
+    ranked_scenario_t *ranked = NULL;
+    ppm_fire_scenario_t scenario;
+    ppm_fire_result_t result;
+    ppm_slab_t slab;
+    MPI_Comm group_comm;
+    MPI_Win queue;
+    FILE *output = stdout;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <manifest|directory> [output] [ranks_per_group]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc >= 4) ranks_per_group = atoi(argv[3]);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const ppm_halo_ops_t *halo = ppm_fire_halo();
+    if (halo == NULL) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+
+    ppm_instr_init();
+
+    /* 1. Rank 0 lists and checks the scenarios, ranks them and sizes the groups */
+    if (rank == 0) {
+        int status;
+        if (stat(argv[1], &listing) == 0 && S_ISDIR(listing.st_mode))
+            status = read_directory(argv[1], &list);
+        else
+            status = read_manifest(argv[1], &list);
+        if (status != 0) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        if (list.count == 0) {
+            fprintf(stderr, "-- Error in ensemble: no scenarios in %s\n", argv[1]);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        count = list.count;
+
+        ranked = (ranked_scenario_t *)malloc(sizeof(ranked_scenario_t) * count);
+        if (ranked == NULL) {
+            fprintf(stderr, "-- Error allocating: ensemble schedule\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        const char *path = list.text;
+        for (s = 0; s < count; s++, path += strlen(path) + 1) {
+            if (ppm_fire_read(path, &scenario) != 0) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            ranked[s].cost = (double)scenario.rows * scenario.columns * scenario.max_iter;
+            ranked[s].index = s;
+            if ((size_t)scenario.rows * scenario.columns > max_cells) {
+                max_cells = (size_t)scenario.rows * scenario.columns;
+                largest_rows = scenario.rows;
+                largest_columns = scenario.columns;
+            }
+            if (s == 0 || scenario.rows < min_rows) min_rows = scenario.rows;
+            ppm_fire_free(&scenario);
+        }
+        qsort(ranked, count, sizeof(ranked_scenario_t), by_decreasing_cost);
+
+        if (ranks_per_group < 1) {
+            ranks_per_group = (int)((max_cells + FIRE_CELLS_PER_RANK - 1) / FIRE_CELLS_PER_RANK);
+            if (ranks_per_group > min_rows) ranks_per_group = min_rows;
+            if (ranks_per_group < 1) ranks_per_group = 1;
+        }
+        if (ranks_per_group > size) ranks_per_group = size;
+        if (ranks_per_group > min_rows) {
+            fprintf(stderr,
+                    "-- Error in ensemble: a scenario has %d rows, fewer than the %d ranks of a "
+                    "group\n",
+                    min_rows, ranks_per_group);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+
+    /* 2. Everybody gets the paths and the order of the queue */
+    MPI_Bcast(&count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&list.length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&ranks_per_group, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank != 0) list.text = (char *)malloc(list.length);
+    order = (int *)malloc(sizeof(int) * count);
+    paths = (char **)malloc(sizeof(char *) * count);
+    lines = (char **)calloc(count, sizeof(char *));
+    if (list.text == NULL || order == NULL || paths == NULL || lines == NULL) {
+        fprintf(stderr, "-- Error allocating: ensemble structures\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    if (rank == 0) {
+        for (s = 0; s < count; s++) order[s] = ranked[s].index;
+        free(ranked);
+    }
+    MPI_Bcast(list.text, list.length, MPI_CHAR, 0, MPI_COMM_WORLD);
+    MPI_Bcast(order, count, MPI_INT, 0, MPI_COMM_WORLD);
+    paths[0] = list.text;
+    for (s = 1; s < count; s++) paths[s] = paths[s - 1] + strlen(paths[s - 1]) + 1;
+
+    /* 3. Groups of ranks_per_group consecutive ranks; the last one gets what is left, so it
+     * never has more ranks than the smallest scenario has rows */
+    groups = (size + ranks_per_group - 1) / ranks_per_group;
+    group = rank / ranks_per_group;
+    MPI_Comm_split(MPI_COMM_WORLD, group, rank, &group_comm);
+    MPI_Comm_rank(group_comm, &group_rank);
+
+    /* The queue counter lives on rank 0: the next position of 'order' to simulate */
+    MPI_Win_allocate(rank == 0 ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, MPI_COMM_WORLD,
+                     &counter, &queue);
+    if (rank == 0) *counter = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    /* 4. Every group takes scenarios from the queue until it is empty */
+    ppm_slab_init(&slab, group_comm, halo);
+    start = MPI_Wtime();
+    for (;;) {
+        if (group_rank == 0) {
+            MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, queue);
+            MPI_Fetch_and_op(&one, &next, MPI_INT, 0, 0, MPI_SUM, queue);
+            MPI_Win_unlock(0, queue);
+        }
+        MPI_Bcast(&next, 1, MPI_INT, 0, group_comm);
+        if (next >= count) break;
+
+        s = order[next];
+        if (ppm_fire_read(paths[s], &scenario) != 0) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        if (ppm_fire_run(&slab, &scenario, &result) != 0) {
+            fprintf(stderr, "-- Error allocating: surface structures of %s\n", paths[s]);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        /* The group root gathers the surface and keeps the result line */
+        if (slab.rank == 0) {
+            float *grown = (float *)realloc(
+                fullSurface, sizeof(float) * (size_t)scenario.rows * (size_t)scenario.columns);
+            if (grown == NULL) {
+                fprintf(stderr, "-- Error allocating: fullSurface of %s\n", paths[s]);
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+            fullSurface = grown;
+        }
+        ppm_slab_gather(&slab, slab.grid[0], fullSurface, 0);
+        if (slab.rank == 0) {
+            if ((lines[s] = result_line(paths[s], &scenario, &result, fullSurface)) == NULL) {
+                fprintf(stderr, "-- Error allocating: result of %s\n", paths[s]);
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+            flops += 6.0 * result.heat_points;
+            bytes += 6.0 * sizeof(real_t) * result.heat_points;
+            total_iterations += result.iterations;
+            if (result.residual > max_residual) max_residual = result.residual;
+        }
+        ppm_fire_free(&scenario);
+    }
+    group_time = MPI_Wtime() - start;
+    ppm_slab_finalize(&slab);
+    MPI_Comm_free(&group_comm);
+    MPI_Win_free(&queue);
+    free(fullSurface);
+
+    /* 5. The group roots send their lines to rank 0, tagged with the scenario */
+    ppm_phase_begin(PPM_PHASE_GATHER);
+    if (rank != 0) {
+        for (s = 0; s < count; s++) {
+            if (lines[s] == NULL) continue;
+            MPI_Send(lines[s], (int)strlen(lines[s]) + 1, MPI_CHAR, 0, s, MPI_COMM_WORLD);
+        }
+    } else {
+        int received = 0, length;
+        MPI_Status status;
+        for (s = 0; s < count; s++) received += lines[s] != NULL;
+        for (; received < count; received++) {
+            MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            MPI_Get_count(&status, MPI_CHAR, &length);
+            if ((lines[status.MPI_TAG] = (char *)malloc(length)) == NULL) {
+                fprintf(stderr, "-- Error allocating: ensemble results\n");
+                MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            }
+            MPI_Recv(lines[status.MPI_TAG], length, MPI_CHAR, status.MPI_SOURCE, status.MPI_TAG,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Reduce(&group_time, &ensemble_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &flops, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &total_iterations, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &max_residual, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+    ppm_phase_end(PPM_PHASE_GATHER);
+
+    /* 6. Combined output in the order of the listing */
+    if (rank == 0) {
+        if (argc >= 3 && strcmp(argv[2], "-") != 0 && (output = fopen(argv[2], "w")) == NULL) {
+            fprintf(stderr, "-- Error in ensemble: cannot write %s\n", argv[2]);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        for (s = 0; s < count; s++) fprintf(output, "%s\n", lines[s]);
+        if (output != stdout) fclose(output);
+        printf("Ensemble: scenarios=%d groups=%d ranks_per_group=%d makespan=%.4f s\n", count,
+               groups, ranks_per_group, ensemble_time);
+    }
+
+    /* Run report of the whole ensemble (only rank 0 writes it): rows and columns are those of the
+     * largest scenario; iterations and work are summed over all scenarios, the residual is the
+     * largest */
+    ppm_run_info_t info = {"fire_ensemble", largest_rows, largest_columns, total_iterations,
+                           max_residual,    flops,        bytes};
+    ppm_report(MPI_COMM_WORLD, &info);
+
+    for (i = 0; i < count; i++) free(lines[i]);
+    free(lines);
+    free(paths);
+    free(order);
+    free(list.text);
+
+    MPI_Finalize();
+    return 0;
+}
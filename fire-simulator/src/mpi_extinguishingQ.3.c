@@ -15,6 +15,9 @@
 #include <string.h>
 #include <sys/time.h>
 
+#include "ppm_fire.h"
+#include "ppm_instr.h"
+
 /* Function to get wall time */
 double cp_Wtime() {
     struct timeval tv;
@@ -49,7 +52,7 @@ typedef struct {
  */
 void show_usage(char *program_name) {
     fprintf(stderr, "Usage: %s <config_file> | <command_line_args>\n", program_name);
-    fprintf(stderr, "\t<config_file> ::= -f <file_name>\n");
+    fprintf(stderr, "\t<config_file> ::= -f <file_name> | -b <binary_file_name>\n");
     fprintf(stderr,
             "\t<command_line_args> ::= <rows> <columns> <maxIter> <numTeams> [ <teamX> <teamY> "
             "<teamType> ... ] <numFocalPoints> [ <focalX> <focalY> <focalStart> <focalTemperature> "
@@ -125,7 +128,7 @@ void print_status(int iteration, int rows, int columns, float *surface, int num_
  * MAIN PROGRAM
  */
 int main(int argc, char *argv[]) {
-    int i, j, t;
+    int i;
 
     // Simulation data
     int rows, columns, max_iter;
@@ -143,6 +146,7 @@ int main(int argc, char *argv[]) {
     }
 
     int read_from_file = !strcmp(argv[1], "-f");
+    int read_from_binary = !strcmp(argv[1], "-b");
     /* 1.2. Read configuration from file */
     if (read_from_file) {
         /* 1.2.1. Open file */
@@ -207,6 +211,35 @@ int main(int argc, char *argv[]) {
             focal[i].active = 0;
         }
     }
+    /* 1.2b. Read configuration from a binary file (tools/generate_scenario.py) */
+    else if (read_from_binary) {
+        ppm_fire_scenario_t scenario;
+        char magic[sizeof(PPM_FIRE_MAGIC) - 1];
+        if (argc < 3) {
+            fprintf(stderr, "-- Error in arguments: file-name argument missing\n");
+            show_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        FILE *args = fopen(argv[2], "rb");
+        if (args == NULL) {
+            fprintf(stderr, "-- Error in file: not found: %s\n", argv[2]);
+            exit(EXIT_FAILURE);
+        }
+        if (fread(magic, 1, sizeof(magic), args) != sizeof(magic) ||
+            memcmp(magic, PPM_FIRE_MAGIC, sizeof(magic)) != 0) {
+            fprintf(stderr, "-- Error in file: not a binary scenario file: %s\n", argv[2]);
+            exit(EXIT_FAILURE);
+        }
+        if (ppm_fire_read_binary(args, argv[2], &scenario) != 0) exit(EXIT_FAILURE);
+        fclose(args);
+        rows = scenario.rows;
+        columns = scenario.columns;
+        max_iter = scenario.max_iter;
+        num_teams = scenario.num_teams;
+        teams = (Team *)scenario.teams;
+        num_focal = scenario.num_focal;
+        focal = (FocalPoint *)scenario.focal;
+    }
     /* 1.3. Read configuration from arguments */
     else {
         /* 1.3.1. Check minimum number of arguments */
@@ -305,258 +338,82 @@ int main(int argc, char *argv[]) {
      *
      */
     /*Start mpi variables*/
-    int rank, size;
-
+    int rank;
+    int iter;
+    ppm_slab_t slab;
+    ppm_fire_result_t result;
+
+#ifdef _OPENMP
+    /* Hybrid build: OpenMP threads share the sweeps and the team phase of every rank, and only
+     * the master thread calls MPI, outside of the parallel regions */
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    if (provided < MPI_THREAD_FUNNELED) {
+        fprintf(stderr, "-- Error in MPI: no MPI_THREAD_FUNNELED support for the hybrid build\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+#else
     MPI_Init(&argc, &argv);
+#endif
 
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
-
-    // Keep a copy of the global total rows
-    int global_rows = rows;
+    /* Halo exchange strategy of ../../libppm/ppm_slab.h, chosen with PPM_HALO */
+    const ppm_halo_ops_t *halo = ppm_fire_halo();
+    if (halo == NULL) MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
 
-    /* Number of real rows per process (assumed divisible) */
-    int chunk = global_rows / size; /* number of real rows owned by each process */
-    int local_nrows = chunk + 2;    /* include two halo rows */
+    /* Row slabs over a graph topology of the slab neighbours, so MPI can place rank - 1 and
+     * rank + 1 close by */
+    ppm_slab_init(&slab, MPI_COMM_WORLD, halo);
+    rank = slab.rank;
 
-    /* Local starting global index for this rank */
-    int g_start = rank * chunk;
-    int g_end = g_start + chunk - 1;
+    ppm_instr_init();
 
-    /* 3. Initialize surfaces (local with halos) */
-    surface = (float *)malloc(sizeof(float) * (size_t)local_nrows * (size_t)columns);
-    surfaceCopy = (float *)malloc(sizeof(float) * (size_t)local_nrows * (size_t)columns);
-    if (surface == NULL || surfaceCopy == NULL) {
+    /* 3. and 4. Initialize the local surfaces and simulate (../../libppm/ppm_fire.c). Team and
+     * FocalPoint are laid out as ppm_team_t and ppm_focal_t: the library updates them in place */
+    ppm_fire_scenario_t scenario = {rows,      columns,
+                                    max_iter,  num_teams,
+                                    num_focal, (ppm_team_t *)teams,
+                                    (ppm_focal_t *)focal};
+    if (ppm_fire_run(&slab, &scenario, &result) != 0) {
         fprintf(stderr, "-- Error allocating: surface structures\n");
+        MPI_Abort(slab.comm, EXIT_FAILURE);
     }
-    for (i = 0; i < local_nrows; i++)
-        for (j = 0; j < columns; j++) {
-            accessMat(surface, i, j) = 0.0;
-            accessMat(surfaceCopy, i, j) = 0.0;
-        }
-
-    /* 4. Simulation */
-    int iter;
-    int flag_stability = 0;
-    int first_activation = 0;
-    for (iter = 0; iter < max_iter && !flag_stability; iter++) {
-        /* 4.1. Activate focal points */
-        int local_num_deactivated = 0; /* local count */
-        for (i = 0; i < num_focal; i++) {
-            if (focal[i].start == iter) {
-                focal[i].active = 1;
-                if (!first_activation) first_activation = 1;
-            }
-            /* Count focal points already deactivated by a team (locally) */
-            if (focal[i].active == 2) local_num_deactivated++;
-        }
-
-        /* We need global_num_deactivated across processes */
-        int num_deactivated = 0;
-        MPI_Allreduce(&local_num_deactivated, &num_deactivated, 1, MPI_INT, MPI_SUM,
-                      MPI_COMM_WORLD);
-
-        /* 4.2. Propagate heat (10 steps per each team movement) */
-        float global_residual = 0.0f;
-        int step;
-
-        for (step = 0; step < 10; step++) {
-            /* 4.2.1. Update heat on active focal points (only if this process owns the row) */
-            for (i = 0; i < num_focal; i++) {
-                if (focal[i].active != 1) continue;
-                int gx = focal[i].x;
-                int gy = focal[i].y;
-                /* Check bounds */
-                if (gx < 0 || gx > global_rows - 1 || gy < 0 || gy > columns - 1) continue;
-                /* If the focal point belongs to this process */
-                if (gx >= g_start && gx <= g_end) {
-                    int local_i = (gx - g_start) + 1; /* local index 1..chunk */
-                    accessMat(surface, local_i, gy) = focal[i].heat;
-                }
-            }
-
-            /* 4.2.1.5 Exchange halo rows with neighbors so halos are up-to-date in 'surface' */
-            MPI_Status status;
-            /* Exchange with top neighbor (rank-1): send local row 1, receive into row 0 */
-            if (rank > 0) {
-                MPI_Sendrecv(&accessMat(surface, 1, 0), columns, MPI_FLOAT, rank - 1, 100,
-                             &accessMat(surface, 0, 0), columns, MPI_FLOAT, rank - 1, 101,
-                             MPI_COMM_WORLD, &status);
-            } else {
-                /* Rank 0: top halo (row 0) corresponds to global border row - keep zeros or
-                 * existing values */
-            }
-            /* Exchange with bottom neighbor (rank+1): send local row chunk, receive into row
-             * chunk+1 */
-            if (rank < size - 1) {
-                MPI_Sendrecv(&accessMat(surface, chunk, 0), columns, MPI_FLOAT, rank + 1, 101,
-                             &accessMat(surface, chunk + 1, 0), columns, MPI_FLOAT, rank + 1, 100,
-                             MPI_COMM_WORLD, &status);
-            } else {
-                /* Last rank: bottom halo remains as border */
-            }
-
-            /* 4.2.2. Copy values of the surface in ancillary structure (including halos) */
-            for (i = 0; i < local_nrows; i++)
-                for (j = 0; j < columns; j++)
-                    accessMat(surfaceCopy, i, j) = accessMat(surface, i, j);
-
-            /* 4.2.3. Update surface values (skip global borders) */
-            /* We update only local real rows (1..chunk) whose global index is in [1 ..
-             * global_rows-2] */
-            for (i = 1; i <= chunk; i++) {
-                int gx = g_start + (i - 1);
-                if (gx < 1 || gx > global_rows - 2) continue; /* skip global border rows */
-                for (j = 1; j < columns - 1; j++) {
-                    accessMat(surface, i, j) =
-                        (accessMat(surfaceCopy, i - 1, j) + accessMat(surfaceCopy, i + 1, j) +
-                         accessMat(surfaceCopy, i, j - 1) + accessMat(surfaceCopy, i, j + 1)) /
-                        4.0f;
-                }
-            }
-
-            /* 4.2.4. Compute the maximum residual difference (absolute value) locally */
-            float local_residual = 0.0f;
-            for (i = 1; i <= chunk; i++) {
-                int gx = g_start + (i - 1);
-                if (gx < 1 || gx > global_rows - 2) continue; /* skip global border rows */
-                for (j = 1; j < columns - 1; j++) {
-                    float diff = fabs(accessMat(surface, i, j) - accessMat(surfaceCopy, i, j));
-                    if (diff > local_residual) local_residual = diff;
-                }
-            }
-            /* Reduce to get the global maximum residual across all processes */
-            MPI_Allreduce(&local_residual, &global_residual, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
-        }
-
-        /* If the global residual is lower than THRESHOLD, we have reached enough stability, stop
-         * simulation at the end of this iteration */
-        if (num_deactivated == num_focal && global_residual < THRESHOLD) flag_stability = 1;
-
-        /* 4.3. Move teams (redundant on all processes) */
-
-        for (t = 0; t < num_teams; t++) {
-            /* 4.3.1. Choose nearest focal point */
-            float distance = FLT_MAX;
-            int target = -1;
-            for (j = 0; j < num_focal; j++) {
-                if (focal[j].active != 1) continue;  // Skip non-active focal points
-                float dx = focal[j].x - teams[t].x;
-                float dy = focal[j].y - teams[t].y;
-                float local_distance = sqrtf(dx * dx + dy * dy);
-                if (local_distance < distance) {
-                    distance = local_distance;
-                    target = j;
-                }
-            }
-            /* 4.3.2. Annotate target for the next stage */
-            teams[t].target = target;
-
-            /* 4.3.3. No active focal point to choose, no movement */
-            if (target == -1) continue;
-
-            /* 4.3.4. Move in the focal point direction */
-            if (teams[t].type == 1) {
-                // Type 1: Can move in diagonal
-                if (focal[target].x < teams[t].x) teams[t].x--;
-                if (focal[target].x > teams[t].x) teams[t].x++;
-                if (focal[target].y < teams[t].y) teams[t].y--;
-                if (focal[target].y > teams[t].y) teams[t].y++;
-            } else if (teams[t].type == 2) {
-                // Type 2: First in horizontal direction, then in vertical direction
-                if (focal[target].y < teams[t].y)
-                    teams[t].y--;
-                else if (focal[target].y > teams[t].y)
-                    teams[t].y++;
-                else if (focal[target].x < teams[t].x)
-                    teams[t].x--;
-                else if (focal[target].x > teams[t].x)
-                    teams[t].x++;
-            } else {
-                // Type 3: First in vertical direction, then in horizontal direction
-                if (focal[target].x < teams[t].x)
-                    teams[t].x--;
-                else if (focal[target].x > teams[t].x)
-                    teams[t].x++;
-                else if (focal[target].y < teams[t].y)
-                    teams[t].y--;
-                else if (focal[target].y > teams[t].y)
-                    teams[t].y++;
-            }
-        }
-
-        /* 4.4. Team actions */
-
-        for (t = 0; t < num_teams; t++) {
-            /* 4.4.1. Deactivate the target focal point when it is reached */
-            int target = teams[t].target;
-            if (target != -1 && focal[target].x == teams[t].x && focal[target].y == teams[t].y &&
-                focal[target].active == 1)
-                focal[target].active = 2;
-
-            /* 4.4.2. Reduce heat in a circle around the team */
-            int radius;
-            // Influence area of fixed radius depending on type
-            if (teams[t].type == 1)
-                radius = RADIUS_TYPE_1;
-            else
-                radius = RADIUS_TYPE_2_3;
-            for (i = teams[t].x - radius; i <= teams[t].x + radius; i++) {
-                for (j = teams[t].y - radius; j <= teams[t].y + radius; j++) {
-                    if (i < 1 || i >= rows - 1 || j < 1 || j >= columns - 1)
-                        continue;  // Out of the heated surface
-                    float dx = teams[t].x - i;
-                    float dy = teams[t].y - j;
-                    float distance = sqrtf(dx * dx + dy * dy);
-                    if (distance <= radius) {
-                        /* Apply update only if this rank owns global row 'i' */
-                        if (i >= g_start && i <= g_end) {
-                            int local_i = (i - g_start) + 1;
-                            accessMat(surface, local_i, j) = accessMat(surface, local_i, j) *
-                                                             (1 - 0.25);  // Team efficiency factor
-                        }
-                    }
-                }
-            }
-        }
-    }
+    iter = result.iterations;
 
     /* After simulation, gather the full surface into rank 0 so the remaining (sequential) code can
      * print results */
     float *fullSurface = NULL;
     if (rank == 0) {
-        fullSurface = (float *)malloc(sizeof(float) * (size_t)global_rows * (size_t)columns);
+        fullSurface = (float *)malloc(sizeof(float) * (size_t)rows * (size_t)columns);
         if (fullSurface == NULL) {
             fprintf(stderr, "-- Error allocating: fullSurface on rank 0\n");
-            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+            MPI_Abort(slab.comm, EXIT_FAILURE);
         }
     }
 
-    /* Prepare send buffer: local real rows are from local index 1 to chunk inclusive */
-    /* Send contiguous block of chunk*columns floats from &accessMat(surface,1,0) */
-    MPI_Gather(&accessMat(surface, 1, 0), chunk * columns, MPI_FLOAT, fullSurface, chunk * columns,
-               MPI_FLOAT, 0, MPI_COMM_WORLD);
+    /* The real rows of every rank, without their padding, land at their rows of fullSurface */
+    ppm_slab_gather(&slab, slab.grid[0], fullSurface, 0);
 
     /* Replace local pointer 'surface' on rank 0 to point to fullSurface for the printing section
-     * below */
-    if (rank == 0) {
-        /* free local small surface and surfaceCopy and set surface to fullSurface */
-        free(surface);
-        free(surfaceCopy);
-        surface = fullSurface;
-        surfaceCopy = NULL;
-    } else {
-        /* other ranks free their local buffers */
-        free(surface);
-        free(surfaceCopy);
-        surface = NULL;
-        surfaceCopy = NULL;
-    }
+     * below. The local surfaces are freed with the slab */
+    surface = fullSurface;
+    surfaceCopy = NULL;
+
+    /* Reduce the per-phase timers and message counters, print them on rank 0 and append the run
+     * report to $PPM_REPORT */
+    ppm_fire_report(&slab, &result);
 
     /* Finalize MPI */
-    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Barrier(slab.comm);
+    ppm_slab_finalize(&slab);
     MPI_Finalize();
 
+    /* Only rank 0 holds the gathered surface: the other ranks leave before the output below */
+    if (rank != 0) {
+        free(teams);
+        free(focal);
+        return 0;
+    }
+
     /*
      *
      * STOP HERE: DO NOT CHANGE THE CODE BELOW THIS POINT
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+Fire Simulator Variant Comparison
+
+Runs every build of the fire simulator on the same scenarios with the same number of cores and
+compares them against the sequential reference (extinguishing.exe):
+
+- openmp:  parallel_extinguishing.exe with --cores threads
+- mpi:     mpi_extinguishing.exe with --cores ranks
+- hybrid:  hybrid_extinguishing.exe with --sockets ranks of --cores / --sockets threads
+
+For each run it prints the `Time:` of the simulator, the speedup over the sequential run and
+whether the `Result:` line is identical to the sequential one. Times are the best of --repeat
+runs. Exits with 1 if any variant prints a different result.
+
+Usage:
+    python3 tools/compare_variants.py [--cores 4] [--sockets 2] [--repeat 1]
+                                      <scenario file or directory> ...
+"""
+
+import argparse
+import os
+import re
+import shlex
+import subprocess
+import sys
+from pathlib import Path
+
+FIRE_DIR = Path(__file__).resolve().parent.parent
+EXECUTABLES = FIRE_DIR / "executables"
+
+
+def scenarios(paths):
+    """Scenario files of the arguments, directories expanded to their files sorted by name."""
+    files = []
+    for path in map(Path, paths):
+        if path.is_dir():
+            files += sorted(p for p in path.iterdir() if p.is_file() and not p.name.startswith("."))
+        else:
+            files.append(path)
+    return files
+
+
+def run(command, threads):
+    """Run one variant, return (time, result line)."""
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    result = subprocess.run(command, env=env, capture_output=True, text=True)
+    time = re.search(r"^Time: (\S+)$", result.stdout, re.MULTILINE)
+    line = re.search(r"^Result:.*$", result.stdout, re.MULTILINE)
+    if result.returncode != 0 or time is None or line is None:
+        print(result.stdout + result.stderr)
+        sys.exit(f"Error: {' '.join(command)} failed")
+    return float(time.group(1)), line.group(0)
+
+
+def best_of(command, threads, repeat):
+    runs = [run(command, threads) for _ in range(repeat)]
+    return min(t for t, _ in runs), runs[0][1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare the fire simulator builds")
+    parser.add_argument("scenarios", nargs="+", help="Scenario files (-f format) or directories")
+    parser.add_argument("--cores", type=int, default=4, help="Threads, ranks, ranks x threads")
+    parser.add_argument("--sockets", type=int, default=2, help="Ranks of the hybrid runs")
+    parser.add_argument("--repeat", type=int, default=1, help="Runs per point, best time kept")
+    parser.add_argument("--mpirun", default="mpirun")
+    parser.add_argument("--mpirun-args", default="--oversubscribe")
+    args = parser.parse_args()
+    if args.cores < 1 or args.sockets < 1 or args.repeat < 1:
+        parser.error("--cores, --sockets and --repeat must be at least 1")
+
+    sockets = min(args.sockets, args.cores)
+    hybrid_threads = max(1, args.cores // sockets)
+    mpirun = [args.mpirun] + shlex.split(args.mpirun_args)
+    variants = [
+        ("openmp", [str(EXECUTABLES / "parallel_extinguishing.exe")], 1, args.cores),
+        (
+            "mpi",
+            mpirun + ["-np", str(args.cores), str(EXECUTABLES / "mpi_extinguishing.exe")],
+            args.cores,
+            1,
+        ),
+        (
+            "hybrid",
+            mpirun + ["-np", str(sockets), str(EXECUTABLES / "hybrid_extinguishing.exe")],
+            sockets,
+            hybrid_threads,
+        ),
+    ]
+
+    failures = 0
+    print(f"{'scenario':<32} {'variant':<10} {'ranks':<6} {'threads':<8} {'time_s':<10} "
+          f"{'speedup':<8} result")
+    for scenario in scenarios(args.scenarios):
+        name = scenario.name
+        sequential = [str(EXECUTABLES / "extinguishing.exe"), "-f", str(scenario)]
+        reference_time, reference = best_of(sequential, 1, args.repeat)
+        print(f"{name:<32} {'sequential':<10} {1:<6} {1:<8} {reference_time:<10.4f} "
+              f"{1.0:<8.2f} {reference}")
+        for variant, command, ranks, threads in variants:
+            time, result = best_of(command + ["-f", str(scenario)], threads, args.repeat)
+            ok = result == reference
+            failures += not ok
+            speedup = reference_time / time if time > 0 else 0.0
+            print(f"{name:<32} {variant:<10} {ranks:<6} {threads:<8} {time:<10.4f} "
+                  f"{speedup:<8.2f} {'same' if ok else result}")
+
+    if failures:
+        print(f"\n{failures} run(s) differ from the sequential result")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""
+Fire Scenario Generator
+
+Writes a seeded, reproducible fire scenario: the same arguments give the same file on every
+machine and Python version (the generator has its own splitmix64 streams, one per quantity, so
+changing the number of focal points does not move the teams).
+
+- Teams:        uniform over the interior of the surface, types drawn with --team-mix weights
+- Focal points: --layout uniform, or clusters: --clusters hot spots of --spread (fraction of
+                the surface side) around uniform centres, which loads a few row slabs only
+- Start times:  --start zero (all at iteration 0), uniform in [0, --start-max], exponential with
+                mean --start-max / 4 (clipped), or waves: --waves bursts spread over
+                [0, --start-max]
+- Heat:         uniform in --heat MIN:MAX
+
+The text file (.txt) uses the "-f" format of the simulators. The binary file (.bin, "-b" option
+and ppm_fire_read()) holds the same values as little-endian 32-bit integers after an 8-byte
+magic:
+
+    "PPMFIRE1" rows columns max_iter num_teams [x y type] * num_teams num_focal
+    [x y start heat] * num_focal
+
+Usage:
+    python3 tools/generate_scenario.py --rows 1000 --columns 100000 --teams 50000
+        --focal 50000 --start waves --seed 7 -o data/input/test4
+"""
+
+import argparse
+import math
+import struct
+import sys
+from array import array
+from pathlib import Path
+
+MAGIC = b"PPMFIRE1"
+MASK = (1 << 64) - 1
+
+# Stream of every quantity, see Rng
+TEAM_POSITION, TEAM_TYPE, FOCAL_POSITION, FOCAL_START, FOCAL_HEAT = range(5)
+
+
+class Rng:
+    """splitmix64 stream 'stream' of seed 'seed'."""
+
+    def __init__(self, seed, stream):
+        self.state = (seed * 0x9E3779B97F4A7C15 + stream * 0xD1B54A32D192ED03) & MASK
+
+    def next(self):
+        self.state = (self.state + 0x9E3779B97F4A7C15) & MASK
+        z = self.state
+        z = ((z ^ (z >> 30)) * 0xBF58476D1CE4E5B9) & MASK
+        z = ((z ^ (z >> 27)) * 0x94D049BB133111EB) & MASK
+        return z ^ (z >> 31)
+
+    def uniform(self):
+        """Float in [0, 1)."""
+        return (self.next() >> 11) * (1.0 / (1 << 53))
+
+    def integer(self, low, high):
+        """Integer in [low, high]."""
+        return low + self.next() % (high - low + 1)
+
+
+def clamp(value, low, high):
+    return max(low, min(high, value))
+
+
+def int_range(text):
+    low, _, high = text.partition(":")
+    try:
+        low, high = int(low), int(high or low)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"'{text}' is not MIN:MAX")
+    if low > high:
+        raise argparse.ArgumentTypeError(f"'{text}': MIN is larger than MAX")
+    return low, high
+
+
+def weights(text):
+    try:
+        values = [float(w) for w in text.split(":")]
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"'{text}' is not W1:W2:W3")
+    if len(values) != 3 or min(values) < 0 or sum(values) <= 0:
+        raise argparse.ArgumentTypeError(f"'{text}': three non-negative weights, not all zero")
+    return values
+
+
+def teams(args):
+    position, kind = Rng(args.seed, TEAM_POSITION), Rng(args.seed, TEAM_TYPE)
+    total = sum(args.team_mix)
+    cumulative = [sum(args.team_mix[: i + 1]) / total for i in range(3)]
+    for _ in range(args.teams):
+        x = position.integer(1, args.rows - 2)
+        y = position.integer(1, args.columns - 2)
+        u = kind.uniform()
+        yield x, y, next(i + 1 for i, c in enumerate(cumulative) if u < c or i == 2)
+
+
+def focal_points(args):
+    position = Rng(args.seed, FOCAL_POSITION)
+    start, heat = Rng(args.seed, FOCAL_START), Rng(args.seed, FOCAL_HEAT)
+    centres = [(position.integer(1, args.rows - 2), position.integer(1, args.columns - 2))
+               for _ in range(args.clusters if args.layout == "clusters" else 0)]
+    waves = sorted(start.integer(0, args.start_max) for _ in range(args.waves))
+    for i in range(args.focal):
+        if centres:
+            # Triangular offsets around the centre of the cluster
+            cx, cy = centres[i % len(centres)]
+            dx = (position.uniform() + position.uniform() - 1.0) * args.spread * args.rows
+            dy = (position.uniform() + position.uniform() - 1.0) * args.spread * args.columns
+            x = clamp(cx + int(dx), 1, args.rows - 2)
+            y = clamp(cy + int(dy), 1, args.columns - 2)
+        else:
+            x = position.integer(1, args.rows - 2)
+            y = position.integer(1, args.columns - 2)
+        if args.start == "zero":
+            when = 0
+        elif args.start == "uniform":
+            when = start.integer(0, args.start_max)
+        elif args.start == "exponential":
+            when = min(args.start_max, int(-args.start_max / 4 * math.log(1.0 - start.uniform())))
+        else:
+            when = waves[start.integer(0, len(waves) - 1)]
+        yield x, y, when, heat.integer(*args.heat)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a seeded fire scenario")
+    parser.add_argument("--rows", type=int, required=True)
+    parser.add_argument("--columns", type=int, required=True)
+    parser.add_argument("--max-iter", type=int, default=1000)
+    parser.add_argument("--teams", type=int, default=10)
+    parser.add_argument("--team-mix", type=weights, default=[1, 1, 1],
+                        help="Weights of team types 1:2:3")
+    parser.add_argument("--focal", type=int, default=10)
+    parser.add_argument("--layout", choices=["uniform", "clusters"], default="uniform")
+    parser.add_argument("--clusters", type=int, default=4)
+    parser.add_argument("--spread", type=float, default=0.05,
+                        help="Cluster half-width, fraction of the surface side")
+    parser.add_argument("--start", choices=["zero", "uniform", "exponential", "waves"],
+                        default="uniform")
+    parser.add_argument("--start-max", type=int, default=100)
+    parser.add_argument("--waves", type=int, default=4)
+    parser.add_argument("--heat", type=int_range, default=(500, 1000), help="MIN:MAX")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--format", choices=["text", "binary", "both"], default="both")
+    parser.add_argument("-o", "--output", required=True,
+                        help="Output path without extension, .txt and .bin are appended")
+    args = parser.parse_args()
+    if args.rows < 3 or args.columns < 3:
+        parser.error("--rows and --columns must be at least 3")
+    if min(args.max_iter, args.teams, args.focal, args.start_max, args.heat[0]) < 0:
+        parser.error("--max-iter, --teams, --focal, --start-max and --heat must not be negative")
+    if args.clusters < 1 or args.waves < 1 or args.seed < 0:
+        parser.error("--clusters and --waves must be at least 1, --seed not negative")
+    if args.rows * args.columns >= 2**31:
+        print(f"Warning: {args.rows} x {args.columns} cells overflow the int indices of the "
+              f"simulators", file=sys.stderr)
+
+    team_list = list(teams(args))
+    focal_list = list(focal_points(args))
+    output = Path(args.output)
+    output.parent.mkdir(parents=True, exist_ok=True)
+
+    if args.format in ("text", "both"):
+        lines = [f"{args.rows} {args.columns} {args.max_iter}", str(len(team_list))]
+        lines += [f"{x} {y} {kind}" for x, y, kind in team_list]
+        lines.append(str(len(focal_list)))
+        lines += [f"{x} {y} {when} {heat}" for x, y, when, heat in focal_list]
+        output.with_suffix(".txt").write_text("\n".join(lines) + "\n")
+    if args.format in ("binary", "both"):
+        values = array("i", [args.rows, args.columns, args.max_iter, len(team_list)])
+        for team in team_list:
+            values.extend(team)
+        values.append(len(focal_list))
+        for point in focal_list:
+            values.extend(point)
+        if values.itemsize != 4:
+            sys.exit("Error: the binary format needs 32-bit integers")
+        if sys.byteorder != "little":
+            values.byteswap()
+        output.with_suffix(".bin").write_bytes(MAGIC + values.tobytes())
+
+    starts = [when for _, _, when, _ in focal_list]
+    print(f"{output}: {args.rows} x {args.columns}, {len(team_list)} teams, "
+          f"{len(focal_list)} focal points starting at "
+          f"{min(starts, default=0)}-{max(starts, default=0)}, seed {args.seed}")
+
+
+if __name__ == "__main__":
+    main()
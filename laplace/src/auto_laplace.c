@@ -0,0 +1,54 @@
+// Laplace solver with an auto-tuned halo exchange: before solving, ppm_tune_halo() looks the
+// fastest strategy for this grid, rank count and node layout up in $PPM_TUNE_DB or calibrates
+// all of them for a few iterations and records the winner. The solver itself lives in
+// ../libppm/ppm_laplace.c.
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppm_instr.h"
+#include "ppm_laplace.h"
+#include "ppm_tune.h"
+
+int main(int argc, char **argv) {
+    int n, m, iter_max = 100;
+    ppm_laplace_t solver;
+
+    if (argc < 3) {
+        printf(
+            "ERROR: Provide the size of the matrix (N, M) as the first and second "
+            "arguments\n");
+        exit(1);
+    }
+    n = atoi(argv[1]);
+    m = atoi(argv[2]);
+
+    // get iter_max from command line at execution time
+    if (argc >= 4) {
+        iter_max = atoi(argv[3]);
+    }
+
+    MPI_Init(&argc, &argv);
+
+    // Calibration runs before ppm_instr_init(), so it stays out of the profile and report
+    ppm_laplace_init(&solver, MPI_COMM_WORLD, ppm_tune_halo(MPI_COMM_WORLD, n, m, stdout));
+
+    ppm_instr_init();
+
+    if (ppm_laplace_setup(&solver, n, m) != 0) {
+        printf("ERROR: Cannot split the %d x %d grid over the ranks or allocate it\n", n, m);
+        exit(1);
+    }
+
+    // Main loop: iterate until error <= tol a maximum of iter_max iterations, printing the
+    // error every 10 iterations
+    ppm_laplace_run(&solver, iter_max, PPM_LAPLACE_TOL, stdout);
+
+    // Reduce the per-phase timers and message counters, print them on rank 0 and append the
+    // run report to $PPM_REPORT
+    ppm_laplace_report(&solver, "auto");
+
+    ppm_laplace_finalize(&solver);
+
+    MPI_Finalize();
+}
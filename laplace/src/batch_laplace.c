@@ -0,0 +1,172 @@
+// Batch Laplace solver: many independent problems in one job
+//
+// The ranks are split with MPI_Comm_split into groups of ranks_per_group consecutive ranks and
+// every problem of the batch file (one "n m iter_max" per line, see ../libppm/ppm_batch.h) is
+// solved whole by one group, with the halo exchange strategy 'halo' among the ranks of the
+// group. Problems are assigned by grid area times iterations, largest first, to the group that
+// finishes them first, so thousands of small grids cost one mpirun and with one rank per group
+// no MPI_Allreduce at all. Each group reuses one solver, and its grid memory, for all of its
+// problems.
+//
+// Rank 0 prints one line per problem in input order, then the estimated and measured makespan:
+//
+//   Problem 3: 1200 x 1200, iterations 100, error 0.035231, group 1, time 0.0821 s
+//   Batch: problems=40 groups=4 ranks_per_group=3 estimated_imbalance=1.02 makespan=1.35 s ...
+//
+// Usage: mpirun -np P batch_laplace.exe <problem_file> [ranks_per_group] [halo]
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppm_batch.h"
+#include "ppm_instr.h"
+#include "ppm_laplace.h"
+#include "ppm_report.h"
+
+int main(int argc, char **argv) {
+    int rank, size, ranks_per_group = 1, groups, group, group_rank, count = 0, p, g;
+    int total_iterations = 0;
+    int *group_ranks, *owner, *iterations;
+    double *errors, *times, makespan, total_cost = 0.0, flops = 0.0, bytes = 0.0, start;
+    double max_error = 0.0, batch_time, group_time;
+    const ppm_halo_ops_t *halo = &ppm_halo_blocking;
+    ppm_problem_t *problems = NULL;
+    ppm_laplace_t solver;
+    MPI_Comm group_comm;
+
+    if (argc < 2) {
+        printf("ERROR: Provide the problem file as the first argument\n");
+        exit(1);
+    }
+    if (argc >= 3) {
+        ranks_per_group = atoi(argv[2]);
+    }
+    if (argc >= 4 && (halo = ppm_halo_find(argv[3])) == NULL) {
+        printf("ERROR: Unknown halo strategy '%s' (blocking, nonblocking, rma, shm)\n", argv[3]);
+        exit(1);
+    }
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    ppm_instr_init();
+
+    if (ranks_per_group < 1 || ranks_per_group > size) ranks_per_group = size;
+
+    // Rank 0 reads the batch, everybody gets a copy
+    if (rank == 0 && (count = ppm_batch_read(argv[1], &problems)) < 0) {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    MPI_Bcast(&count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank != 0 || problems == NULL) {
+        problems = (ppm_problem_t *)malloc(sizeof(ppm_problem_t) * (count + 1));
+    }
+    owner = (int *)malloc(sizeof(int) * (count + 1));
+    iterations = (int *)calloc(count + 1, sizeof(int));
+    errors = (double *)calloc(count + 1, sizeof(double));
+    times = (double *)calloc(count + 1, sizeof(double));
+    if (problems == NULL || owner == NULL || iterations == NULL || errors == NULL ||
+        times == NULL) {
+        printf("Malloc of the batch failed!\n");
+        exit(1);
+    }
+    MPI_Bcast(problems, 3 * count, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Groups of ranks_per_group consecutive ranks; the last one takes what is left
+    groups = (size + ranks_per_group - 1) / ranks_per_group;
+    group = rank / ranks_per_group;
+    group_ranks = (int *)malloc(sizeof(int) * groups);
+    for (g = 0; g < groups; g++) {
+        group_ranks[g] = g < groups - 1 ? ranks_per_group : size - g * ranks_per_group;
+    }
+    for (p = 0; p < count; p++) {
+        if (problems[p].n < group_ranks[0]) {
+            if (rank == 0) {
+                printf("ERROR: Problem %d has %d rows, fewer than the %d ranks of a group\n", p,
+                       problems[p].n, group_ranks[0]);
+            }
+            MPI_Finalize();
+            exit(1);
+        }
+    }
+    makespan = ppm_batch_schedule(problems, count, group_ranks, groups, owner);
+
+    MPI_Comm_split(MPI_COMM_WORLD, group, rank, &group_comm);
+    MPI_Comm_rank(group_comm, &group_rank);
+
+    // Solve my group's problems one after the other with the same solver
+    ppm_laplace_init(&solver, group_comm, halo);
+    start = MPI_Wtime();
+    for (p = 0; p < count; p++) {
+        if (owner[p] != group) continue;
+
+        times[p] = MPI_Wtime();
+        if (ppm_laplace_setup(&solver, problems[p].n, problems[p].m) != 0) {
+            printf("ERROR: Cannot allocate problem %d (%d x %d)\n", p, problems[p].n,
+                   problems[p].m);
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        ppm_laplace_run(&solver, problems[p].iter_max, PPM_LAPLACE_TOL, NULL);
+        times[p] = MPI_Wtime() - times[p];
+
+        // Only the group root contributes the results, the sum below collects them on rank 0
+        if (group_rank != 0) {
+            times[p] = 0.0;
+            continue;
+        }
+        iterations[p] = solver.iter;
+        errors[p] = ACC_SQRT(solver.error);
+    }
+    group_time = MPI_Wtime() - start;
+    ppm_laplace_finalize(&solver);
+    MPI_Comm_free(&group_comm);
+
+    ppm_phase_begin(PPM_PHASE_GATHER);
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : iterations, iterations, count, MPI_INT, MPI_SUM, 0,
+               MPI_COMM_WORLD);
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : errors, errors, count, MPI_DOUBLE, MPI_SUM, 0,
+               MPI_COMM_WORLD);
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : times, times, count, MPI_DOUBLE, MPI_SUM, 0,
+               MPI_COMM_WORLD);
+    MPI_Reduce(&group_time, &batch_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    ppm_phase_end(PPM_PHASE_GATHER);
+
+    if (rank == 0) {
+        for (p = 0; p < count; p++) {
+            printf("Problem %d: %d x %d, iterations %d, error %f, group %d, time %.4f s\n", p,
+                   problems[p].n, problems[p].m, iterations[p], errors[p], owner[p], times[p]);
+            total_cost += ppm_problem_cost(&problems[p]);
+            flops += 6.0 * (problems[p].n - 2) * (problems[p].m - 2) * iterations[p];
+            bytes += 2.0 * sizeof(real_t) * (problems[p].n - 2) * (problems[p].m - 2) *
+                     iterations[p];
+            total_iterations += iterations[p];
+            if (errors[p] > max_error) max_error = errors[p];
+        }
+        // Imbalance of the schedule: largest group load over the ideal one (1 = perfect)
+        printf("Batch: problems=%d groups=%d ranks_per_group=%d estimated_imbalance=%.2f "
+               "makespan=%.4f s\n",
+               count, groups, ranks_per_group, total_cost > 0 ? makespan * size / total_cost : 1.0,
+               batch_time);
+    }
+
+    // Run report of the whole batch (only rank 0 writes it): rows and columns are those of the
+    // first problem; iterations and work are summed over all problems, the error is the largest
+    ppm_run_info_t info = {"batch",
+                           count > 0 ? problems[0].n : 0,
+                           count > 0 ? problems[0].m : 0,
+                           total_iterations,
+                           max_error,
+                           flops,
+                           bytes};
+    ppm_report(MPI_COMM_WORLD, &info);
+
+    free(problems);
+    free(owner);
+    free(iterations);
+    free(errors);
+    free(times);
+    free(group_ranks);
+
+    MPI_Finalize();
+}
@@ -0,0 +1,244 @@
+// Halo-exchange and reduction microbenchmark for the row-slab layout
+//
+// Reproduces the communication of one iteration of blocking_laplace.c without any compute:
+// every rank sends m floats to each of its neighbours (rank - 1 and rank + 1, non-periodic)
+// and receives their boundary rows into its halo rows, followed by the per-iteration
+// MPI_Allreduce of one float. Exchange strategies:
+//
+//   sendrecv    MPI_Sendrecv per neighbour (blocking_laplace.c)
+//   isend       MPI_Irecv/MPI_Isend + MPI_Waitall (non_blocking_laplace.c)
+//   persistent  MPI_Recv_init/MPI_Send_init once, MPI_Startall + MPI_Waitall per exchange
+//   rma_fence   MPI_Put into the neighbours' halo rows between two MPI_Win_fence
+//   rma_pscw    MPI_Put under post-start-complete-wait with the neighbour group only
+//   allreduce   MPI_Allreduce of one float with MPI_MAX (m is ignored)
+//
+// The sweep covers m from 1 to max_m floats (powers of two) and communicators of 2, 4, 8, ...
+// ranks up to the full job, so latency, bandwidth and scaling of each strategy are isolated
+// from compute and load imbalance. Rank 0 prints CSV:
+//
+//   variant,ranks,m,bytes,reps,time_us_min,time_us_avg,time_us_max,gbytes_per_s
+//
+// where times are per exchange and bandwidth is the bytes one interior rank sends per exchange
+// over the average time.
+//
+// Usage: mpirun -np P halo_bench.exe [max_m] [min_reps]
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum { SENDRECV, ISEND, PERSISTENT, RMA_FENCE, RMA_PSCW, ALLREDUCE, NUM_VARIANTS } variant_t;
+
+static const char *variant_names[NUM_VARIANTS] = {"sendrecv",  "isend",    "persistent",
+                                                  "rma_fence", "rma_pscw", "allreduce"};
+
+// State of one rank of the slab: rows 0 (top halo), 1 (first real), 2 (last real), 3 (bottom
+// halo), each m floats
+typedef struct {
+    MPI_Comm comm;
+    int rank, size, m;
+    float *rows;
+    MPI_Request requests[4];
+    int num_requests;
+    MPI_Win win;
+    MPI_Group neighbours;
+} slab_t;
+
+#define ROW(s, r) (&(s)->rows[(size_t)(r) * (s)->m])
+
+static void setup(slab_t *s, variant_t variant) {
+    int n = 0, ranks[2];
+    MPI_Group group;
+
+    s->num_requests = 0;
+    if (variant == PERSISTENT) {
+        if (s->rank > 0) {
+            MPI_Recv_init(ROW(s, 0), s->m, MPI_FLOAT, s->rank - 1, s->rank - 1, s->comm,
+                          &s->requests[s->num_requests++]);
+            MPI_Send_init(ROW(s, 1), s->m, MPI_FLOAT, s->rank - 1, s->rank, s->comm,
+                          &s->requests[s->num_requests++]);
+        }
+        if (s->rank < s->size - 1) {
+            MPI_Recv_init(ROW(s, 3), s->m, MPI_FLOAT, s->rank + 1, s->rank + 1, s->comm,
+                          &s->requests[s->num_requests++]);
+            MPI_Send_init(ROW(s, 2), s->m, MPI_FLOAT, s->rank + 1, s->rank, s->comm,
+                          &s->requests[s->num_requests++]);
+        }
+    } else if (variant == RMA_FENCE || variant == RMA_PSCW) {
+        MPI_Win_create(s->rows, sizeof(float) * 4 * s->m, sizeof(float), MPI_INFO_NULL, s->comm,
+                       &s->win);
+        if (s->rank > 0) ranks[n++] = s->rank - 1;
+        if (s->rank < s->size - 1) ranks[n++] = s->rank + 1;
+        MPI_Comm_group(s->comm, &group);
+        MPI_Group_incl(group, n, ranks, &s->neighbours);
+        MPI_Group_free(&group);
+        if (variant == RMA_FENCE) MPI_Win_fence(MPI_MODE_NOPRECEDE, s->win);
+    }
+}
+
+static void teardown(slab_t *s, variant_t variant) {
+    int r;
+
+    if (variant == PERSISTENT) {
+        for (r = 0; r < s->num_requests; r++) MPI_Request_free(&s->requests[r]);
+    } else if (variant == RMA_FENCE || variant == RMA_PSCW) {
+        if (variant == RMA_FENCE) MPI_Win_fence(MPI_MODE_NOSUCCEED, s->win);
+        MPI_Group_free(&s->neighbours);
+        MPI_Win_free(&s->win);
+    }
+}
+
+// One halo exchange (or one reduction) with the given strategy
+static void exchange(slab_t *s, variant_t variant) {
+    const int m = s->m, rank = s->rank, size = s->size;
+    float error = (float)rank, global_error;
+
+    switch (variant) {
+        case SENDRECV:
+            if (rank > 0) {
+                MPI_Sendrecv(ROW(s, 1), m, MPI_FLOAT, rank - 1, rank, ROW(s, 0), m, MPI_FLOAT,
+                             rank - 1, rank - 1, s->comm, MPI_STATUS_IGNORE);
+            }
+            if (rank < size - 1) {
+                MPI_Sendrecv(ROW(s, 2), m, MPI_FLOAT, rank + 1, rank, ROW(s, 3), m, MPI_FLOAT,
+                             rank + 1, rank + 1, s->comm, MPI_STATUS_IGNORE);
+            }
+            break;
+        case ISEND:
+            s->num_requests = 0;
+            if (rank > 0) {
+                MPI_Irecv(ROW(s, 0), m, MPI_FLOAT, rank - 1, rank - 1, s->comm,
+                          &s->requests[s->num_requests++]);
+                MPI_Isend(ROW(s, 1), m, MPI_FLOAT, rank - 1, rank, s->comm,
+                          &s->requests[s->num_requests++]);
+            }
+            if (rank < size - 1) {
+                MPI_Irecv(ROW(s, 3), m, MPI_FLOAT, rank + 1, rank + 1, s->comm,
+                          &s->requests[s->num_requests++]);
+                MPI_Isend(ROW(s, 2), m, MPI_FLOAT, rank + 1, rank, s->comm,
+                          &s->requests[s->num_requests++]);
+            }
+            MPI_Waitall(s->num_requests, s->requests, MPI_STATUSES_IGNORE);
+            break;
+        case PERSISTENT:
+            MPI_Startall(s->num_requests, s->requests);
+            MPI_Waitall(s->num_requests, s->requests, MPI_STATUSES_IGNORE);
+            break;
+        case RMA_FENCE:
+        case RMA_PSCW:
+            if (variant == RMA_PSCW) {
+                MPI_Win_post(s->neighbours, 0, s->win);
+                MPI_Win_start(s->neighbours, 0, s->win);
+            }
+            // My first real row is the bottom halo (row 3) of rank - 1, my last real row the
+            // top halo (row 0) of rank + 1
+            if (rank > 0) MPI_Put(ROW(s, 1), m, MPI_FLOAT, rank - 1, 3 * m, m, MPI_FLOAT, s->win);
+            if (rank < size - 1) MPI_Put(ROW(s, 2), m, MPI_FLOAT, rank + 1, 0, m, MPI_FLOAT, s->win);
+            if (variant == RMA_PSCW) {
+                MPI_Win_complete(s->win);
+                MPI_Win_wait(s->win);
+            } else {
+                MPI_Win_fence(0, s->win);
+            }
+            break;
+        case ALLREDUCE:
+            MPI_Allreduce(&error, &global_error, 1, MPI_FLOAT, MPI_MAX, s->comm);
+            break;
+        default:
+            break;
+    }
+}
+
+// Time 'reps' exchanges and print one CSV row on the communicator's rank 0
+static void measure(slab_t *s, variant_t variant, int reps) {
+    double t, t_min, t_max, t_sum;
+    int r;
+
+    setup(s, variant);
+
+    // Warm up connections and windows
+    for (r = 0; r < 5; r++) exchange(s, variant);
+
+    MPI_Barrier(s->comm);
+    t = MPI_Wtime();
+    for (r = 0; r < reps; r++) exchange(s, variant);
+    t = (MPI_Wtime() - t) / reps;
+
+    teardown(s, variant);
+
+    MPI_Reduce(&t, &t_min, 1, MPI_DOUBLE, MPI_MIN, 0, s->comm);
+    MPI_Reduce(&t, &t_max, 1, MPI_DOUBLE, MPI_MAX, 0, s->comm);
+    MPI_Reduce(&t, &t_sum, 1, MPI_DOUBLE, MPI_SUM, 0, s->comm);
+
+    if (s->rank == 0) {
+        // An interior rank sends one row to each side per exchange
+        double bytes = variant == ALLREDUCE ? sizeof(float) : 2.0 * sizeof(float) * s->m;
+        double t_avg = t_sum / s->size;
+        printf("%s,%d,%d,%.0f,%d,%.3f,%.3f,%.3f,%.4f\n", variant_names[variant], s->size,
+               variant == ALLREDUCE ? 1 : s->m, bytes, reps, t_min * 1e6, t_avg * 1e6,
+               t_max * 1e6, bytes / t_avg * 1e-9);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv) {
+    int world_rank, world_size, max_m = 1 << 16, min_reps = 50, size, m, v;
+    slab_t slab;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    if (argc >= 2) max_m = atoi(argv[1]);
+    if (argc >= 3) min_reps = atoi(argv[2]);
+
+    if (world_size < 2) {
+        if (world_rank == 0) printf("ERROR: Run with at least 2 MPI processes\n");
+        MPI_Finalize();
+        exit(1);
+    }
+
+    if ((slab.rows = malloc(sizeof(float) * 4 * (size_t)max_m)) == NULL) {
+        printf("Malloc of halo rows failed!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (m = 0; m < 4 * max_m; m++) slab.rows[m] = (float)world_rank;
+
+    if (world_rank == 0) {
+        printf("variant,ranks,m,bytes,reps,time_us_min,time_us_avg,time_us_max,gbytes_per_s\n");
+    }
+
+    // Communicators of 2, 4, 8, ... ranks and finally the whole job
+    size = 2;
+    while (1) {
+        MPI_Comm_split(MPI_COMM_WORLD, world_rank < size ? 0 : MPI_UNDEFINED, world_rank,
+                       &slab.comm);
+
+        if (slab.comm != MPI_COMM_NULL) {
+            MPI_Comm_rank(slab.comm, &slab.rank);
+            MPI_Comm_size(slab.comm, &slab.size);
+
+            slab.m = 1;
+            measure(&slab, ALLREDUCE, 10 * min_reps);
+
+            for (m = 1; m <= max_m; m *= 2) {
+                // Fewer repetitions for large rows: about 64 MiB per rank and variant
+                int reps = (int)((64L << 20) / (8L * m));
+                if (reps < min_reps) reps = min_reps;
+                if (reps > 20 * min_reps) reps = 20 * min_reps;
+
+                slab.m = m;
+                for (v = SENDRECV; v < ALLREDUCE; v++) measure(&slab, v, reps);
+            }
+
+            MPI_Comm_free(&slab.comm);
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (size == world_size) break;
+        size = size * 2 < world_size ? size * 2 : world_size;
+    }
+
+    free(slab.rows);
+    MPI_Finalize();
+}
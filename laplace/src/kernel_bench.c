@@ -0,0 +1,383 @@
+// Roofline-style microbenchmark of the stencil kernels
+//
+// Times every variant of the Laplace Jacobi sweep (laplace.c) and of the fire simulator heat
+// step (4.2.2-4.2.4 of mpi_extinguishingQ.3.c) on square grids from L1-resident to
+// DRAM-resident, and compares the achieved bandwidth against a STREAM triad measured on the
+// same node. Output is CSV on stdout:
+//
+//   kernel,variant,size,working_set_kib,sweeps,seconds,glups,gbytes_per_s,pct_triad
+//
+// GLUP/s are grid-point updates per second. GB/s use the compulsory traffic of each variant
+// (bytes that must cross the memory interface per update when nothing is cached), so a
+// DRAM-resident kernel at 100% of the triad bandwidth is at the roofline.
+//
+// Usage: kernel_bench.exe [max_size] [min_seconds]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TILE_J 512
+
+// Every kernel leaves its result in A; B is the second grid (Anew, the ancillary copy, or scratch)
+typedef float (*sweep_fn)(float *restrict A, float *restrict B, int n, int m);
+
+static double wtime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+}
+
+static float *alloc_grid(int n, int m) {
+    float *grid;
+
+    if ((grid = aligned_alloc(64, ((sizeof(float) * n * m + 63) / 64) * 64)) == NULL) {
+        printf("Malloc of %d x %d grid failed!\n", n, m);
+        exit(1);
+    }
+    return grid;
+}
+
+// Fill a grid with reproducible pseudo-random values so the kernels do real work from the
+// first sweep
+static void init_grid(float *A, int n, int m) {
+    unsigned int seed = 12345;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+            seed = seed * 1103515245u + 12345u;
+            A[i * m + j] = (seed >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Laplace Jacobi sweep: Anew = average of the 4 neighbours of A, returns max |Anew - A|
+// ---------------------------------------------------------------------------------------------
+
+// Same loop as laplace.c
+static float jacobi_baseline(float *restrict A, float *restrict Anew, int n, int m) {
+    float error = 0.0f;
+
+    for (int i = 1; i < n - 1; i++) {
+        for (int j = 1; j < m - 1; j++) {
+            Anew[i * m + j] =
+                (A[(i - 1) * m + j] + A[(i + 1) * m + j] + A[i * m + (j - 1)] + A[i * m + (j + 1)]) /
+                4;
+            error = fmaxf(error, fabsf(Anew[i * m + j] - A[i * m + j]));
+        }
+    }
+    return error;
+}
+
+// One row of the vectorized sweep: row pointers and an explicit SIMD max reduction
+static inline float jacobi_row(const float *restrict up, const float *restrict mid,
+                               const float *restrict down, float *restrict out, int j_start,
+                               int j_end) {
+    float error = 0.0f;
+
+#pragma omp simd reduction(max : error)
+    for (int j = j_start; j < j_end; j++) {
+        out[j] = (up[j] + down[j] + mid[j - 1] + mid[j + 1]) * 0.25f;
+        error = fmaxf(error, fabsf(out[j] - mid[j]));
+    }
+    return error;
+}
+
+static float jacobi_vectorized(float *restrict A, float *restrict Anew, int n, int m) {
+    float error = 0.0f;
+
+    for (int i = 1; i < n - 1; i++) {
+        error = fmaxf(error, jacobi_row(&A[(i - 1) * m], &A[i * m], &A[(i + 1) * m], &Anew[i * m],
+                                        1, m - 1));
+    }
+    return error;
+}
+
+// Column-blocked sweep: the three input rows of a tile stay in L1 across the tile
+static float jacobi_tiled(float *restrict A, float *restrict Anew, int n, int m) {
+    float error = 0.0f;
+
+    for (int jj = 1; jj < m - 1; jj += TILE_J) {
+        int j_end = jj + TILE_J < m - 1 ? jj + TILE_J : m - 1;
+        for (int i = 1; i < n - 1; i++) {
+            error = fmaxf(error, jacobi_row(&A[(i - 1) * m], &A[i * m], &A[(i + 1) * m],
+                                            &Anew[i * m], jj, j_end));
+        }
+    }
+    return error;
+}
+
+// Two Jacobi sweeps fused into one pass over memory (temporal blocking with a one-row lag).
+// Row i of sweep 1 goes to a ring of three rows, then row i - 1 of sweep 2 is computed from the
+// ring and written back into A, whose old row i - 1 sweep 1 no longer needs. Only A crosses the
+// memory interface: one load and one store per two updates. The error is the one of sweep 2.
+// The ring is the first three rows of B, allocated by the caller outside the timed loop
+static float jacobi_fused(float *restrict A, float *restrict B, int n, int m) {
+    float error = 0.0f;
+    float *restrict ring = B;
+
+    memcpy(&ring[0], &A[0], sizeof(float) * m);
+    for (int i = 1; i < n; i++) {
+        float *restrict row = &ring[(i % 3) * m];
+
+        if (i < n - 1) {
+            row[0] = A[i * m];
+            row[m - 1] = A[i * m + m - 1];
+            jacobi_row(&A[(i - 1) * m], &A[i * m], &A[(i + 1) * m], row, 1, m - 1);
+        } else {
+            memcpy(row, &A[i * m], sizeof(float) * m);
+        }
+        if (i >= 2) {
+            error = fmaxf(error, jacobi_row(&ring[((i - 2) % 3) * m], &ring[((i - 1) % 3) * m],
+                                            row, &A[(i - 1) * m], 1, m - 1));
+        }
+    }
+    return error;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Fire simulator heat step: copy, 4-point stencil and max residual
+// ---------------------------------------------------------------------------------------------
+
+// Same three passes as 4.2.2-4.2.4: copy into the ancillary grid, update, residual
+static float heat_baseline(float *restrict surface, float *restrict copy, int n, int m) {
+    float residual = 0.0f;
+
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < m; j++) copy[i * m + j] = surface[i * m + j];
+    for (int i = 1; i < n - 1; i++)
+        for (int j = 1; j < m - 1; j++)
+            surface[i * m + j] = (copy[(i - 1) * m + j] + copy[(i + 1) * m + j] +
+                                  copy[i * m + j - 1] + copy[i * m + j + 1]) /
+                                 4.0f;
+    for (int i = 1; i < n - 1; i++)
+        for (int j = 1; j < m - 1; j++) {
+            float diff = fabsf(surface[i * m + j] - copy[i * m + j]);
+            if (diff > residual) residual = diff;
+        }
+    return residual;
+}
+
+// Copy elided by swapping buffers and residual fused into the stencil pass
+static float heat_fused(float *restrict surface, float *restrict next, int n, int m) {
+    float residual = 0.0f;
+
+    for (int i = 1; i < n - 1; i++)
+        for (int j = 1; j < m - 1; j++) {
+            next[i * m + j] = (surface[(i - 1) * m + j] + surface[(i + 1) * m + j] +
+                               surface[i * m + j - 1] + surface[i * m + j + 1]) /
+                              4.0f;
+            float diff = fabsf(next[i * m + j] - surface[i * m + j]);
+            if (diff > residual) residual = diff;
+        }
+    return residual;
+}
+
+// One row of the vectorized heat step: the update of 4.2.3 with the residual of 4.2.4 as an
+// explicit SIMD max reduction, reading 'surface' and writing 'next' (copy elided)
+static inline float heat_row(const float *restrict up, const float *restrict mid,
+                             const float *restrict down, float *restrict out, int j_start,
+                             int j_end) {
+    float residual = 0.0f;
+
+#pragma omp simd reduction(max : residual)
+    for (int j = j_start; j < j_end; j++) {
+        out[j] = (up[j] + down[j] + mid[j - 1] + mid[j + 1]) / 4.0f;
+        float diff = fabsf(out[j] - mid[j]);
+        if (diff > residual) residual = diff;
+    }
+    return residual;
+}
+
+static float heat_vectorized(float *restrict surface, float *restrict next, int n, int m) {
+    float residual = 0.0f;
+
+    for (int i = 1; i < n - 1; i++) {
+        residual = fmaxf(residual, heat_row(&surface[(i - 1) * m], &surface[i * m],
+                                            &surface[(i + 1) * m], &next[i * m], 1, m - 1));
+    }
+    return residual;
+}
+
+// Column-blocked heat step: the three surface rows of a tile stay in L1 across the tile
+static float heat_tiled(float *restrict surface, float *restrict next, int n, int m) {
+    float residual = 0.0f;
+
+    for (int jj = 1; jj < m - 1; jj += TILE_J) {
+        int j_end = jj + TILE_J < m - 1 ? jj + TILE_J : m - 1;
+        for (int i = 1; i < n - 1; i++) {
+            residual = fmaxf(residual, heat_row(&surface[(i - 1) * m], &surface[i * m],
+                                                &surface[(i + 1) * m], &next[i * m], jj, j_end));
+        }
+    }
+    return residual;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Driver
+// ---------------------------------------------------------------------------------------------
+
+typedef struct {
+    const char *kernel;
+    const char *variant;
+    sweep_fn fn;
+    int sweeps_per_call;    // Jacobi sweeps performed by one call
+    int swap;               // Swap the grids after each call
+    double bytes_per_point; // Compulsory traffic per grid-point update
+} variant_t;
+
+static const variant_t variants[] = {
+    {"jacobi", "baseline", jacobi_baseline, 1, 1, 8.0},
+    {"jacobi", "vectorized", jacobi_vectorized, 1, 1, 8.0},
+    {"jacobi", "tiled", jacobi_tiled, 1, 1, 8.0},
+    {"jacobi", "fused", jacobi_fused, 2, 0, 4.0},
+    {"heat", "baseline", heat_baseline, 1, 0, 24.0},
+    {"heat", "fused", heat_fused, 1, 1, 8.0},
+    {"heat", "vectorized", heat_vectorized, 1, 1, 8.0},
+    {"heat", "tiled", heat_tiled, 1, 1, 8.0},
+};
+
+#define NUM_VARIANTS ((int)(sizeof(variants) / sizeof(variants[0])))
+
+// STREAM triad a = b + s * c on arrays of 'len' doubles; returns the best GB/s of 'reps' runs
+static double stream_triad(size_t len, int reps) {
+    double *a, *b, *c, best = 0.0;
+
+    a = aligned_alloc(64, sizeof(double) * len);
+    b = aligned_alloc(64, sizeof(double) * len);
+    c = aligned_alloc(64, sizeof(double) * len);
+    if (a == NULL || b == NULL || c == NULL) {
+        printf("Malloc of triad arrays failed!\n");
+        exit(1);
+    }
+    for (size_t k = 0; k < len; k++) {
+        a[k] = 0.0;
+        b[k] = 1.0;
+        c[k] = 2.0;
+    }
+
+    for (int r = 0; r < reps; r++) {
+        double t = wtime();
+#pragma omp simd
+        for (size_t k = 0; k < len; k++) a[k] = b[k] + 3.0 * c[k];
+        t = wtime() - t;
+        double gbs = 3.0 * sizeof(double) * len / t * 1e-9;
+        if (gbs > best) best = gbs;
+    }
+    if (a[len / 2] != 7.0) printf("Triad validation failed!\n");
+
+    free(a);
+    free(b);
+    free(c);
+    return best;
+}
+
+// Check every variant against its baseline on a small grid (4 sweeps, exact float equality)
+static void validate(void) {
+    const int n = 67, m = 61;
+    float *ref = alloc_grid(n, m), *ref_new = alloc_grid(n, m);
+    float *A = alloc_grid(n, m), *Anew = alloc_grid(n, m), *tmp;
+
+    for (int v = 0; v < NUM_VARIANTS; v++) {
+        const variant_t *base = &variants[strcmp(variants[v].kernel, "jacobi") == 0 ? 0 : 4];
+
+        init_grid(ref, n, m);
+        init_grid(A, n, m);
+        memcpy(ref_new, ref, sizeof(float) * n * m);
+        memcpy(Anew, A, sizeof(float) * n * m);
+
+        for (int s = 0; s < 4; s += base->sweeps_per_call) {
+            base->fn(ref, ref_new, n, m);
+            if (base->swap) {
+                tmp = ref;
+                ref = ref_new;
+                ref_new = tmp;
+            }
+        }
+        for (int s = 0; s < 4; s += variants[v].sweeps_per_call) {
+            variants[v].fn(A, Anew, n, m);
+            if (variants[v].swap) {
+                tmp = A;
+                A = Anew;
+                Anew = tmp;
+            }
+        }
+
+        if (memcmp(ref, A, sizeof(float) * n * m) != 0) {
+            printf("ERROR: %s/%s does not match %s/baseline\n", variants[v].kernel,
+                   variants[v].variant, variants[v].kernel);
+            exit(1);
+        }
+    }
+
+    free(ref);
+    free(ref_new);
+    free(A);
+    free(Anew);
+}
+
+int main(int argc, char **argv) {
+    int max_size = 8192;
+    double min_seconds = 0.2;
+    long llc_bytes;
+    size_t triad_len;
+    double triad_gbs;
+
+    if (argc >= 2) max_size = atoi(argv[1]);
+    if (argc >= 3) min_seconds = atof(argv[2]);
+
+    validate();
+
+    // STREAM rule: each triad array at least 4x the last-level cache
+    llc_bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (llc_bytes <= 0) llc_bytes = 32L << 20;
+    triad_len = 4 * (size_t)llc_bytes / sizeof(double);
+    triad_gbs = stream_triad(triad_len, 10);
+    printf("# STREAM triad: %.2f GB/s (3 x %zu MiB arrays)\n", triad_gbs,
+           triad_len * sizeof(double) >> 20);
+    printf("kernel,variant,size,working_set_kib,sweeps,seconds,glups,gbytes_per_s,pct_triad\n");
+
+    for (int size = 32; size <= max_size; size *= 2) {
+        float *A = alloc_grid(size, size), *Anew = alloc_grid(size, size), *tmp;
+        const double points = (double)(size - 2) * (size - 2);
+
+        for (int v = 0; v < NUM_VARIANTS; v++) {
+            const variant_t *var = &variants[v];
+            int calls = 1, sweeps;
+            double seconds;
+
+            init_grid(A, size, size);
+            memcpy(Anew, A, sizeof(float) * size * size);
+
+            // Warm up, then double the number of calls until the run is long enough
+            var->fn(A, Anew, size, size);
+            do {
+                seconds = wtime();
+                for (int c = 0; c < calls; c++) {
+                    var->fn(A, Anew, size, size);
+                    if (var->swap) {
+                        tmp = A;
+                        A = Anew;
+                        Anew = tmp;
+                    }
+                }
+                seconds = wtime() - seconds;
+                calls *= 2;
+            } while (seconds < min_seconds);
+            sweeps = calls / 2 * var->sweeps_per_call;
+
+            double glups = points * sweeps / seconds * 1e-9;
+            double gbs = glups * var->bytes_per_point;
+            printf("%s,%s,%d,%zu,%d,%.6f,%.4f,%.4f,%.2f\n", var->kernel, var->variant, size,
+                   2 * sizeof(float) * size * size >> 10, sweeps, seconds, glups, gbs,
+                   gbs / triad_gbs * 100);
+            fflush(stdout);
+        }
+
+        free(A);
+        free(Anew);
+    }
+}
@@ -0,0 +1,52 @@
+// Laplace solver with one-sided halo exchange: each rank exposes A and Anew through one MPI_Win
+// and pushes its boundary rows into the neighbours' halo rows with MPI_Put under
+// post-start-complete-wait synchronization, so there is no message matching and no
+// unexpected-message queue. The solver itself lives in ../libppm/ppm_laplace.c.
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppm_instr.h"
+#include "ppm_laplace.h"
+
+int main(int argc, char **argv) {
+    int n, m, iter_max = 100;
+    ppm_laplace_t solver;
+
+    if (argc < 3) {
+        printf(
+            "ERROR: Provide the size of the matrix (N, M) as the first and second "
+            "arguments\n");
+        exit(1);
+    }
+    n = atoi(argv[1]);
+    m = atoi(argv[2]);
+
+    // get iter_max from command line at execution time
+    if (argc >= 4) {
+        iter_max = atoi(argv[3]);
+    }
+
+    MPI_Init(&argc, &argv);
+
+    ppm_laplace_init(&solver, MPI_COMM_WORLD, &ppm_halo_rma);
+
+    ppm_instr_init();
+
+    if (ppm_laplace_setup(&solver, n, m) != 0) {
+        printf("ERROR: Cannot split the %d x %d grid over the ranks or allocate it\n", n, m);
+        exit(1);
+    }
+
+    // Main loop: iterate until error <= tol a maximum of iter_max iterations, printing the
+    // error every 10 iterations
+    ppm_laplace_run(&solver, iter_max, PPM_LAPLACE_TOL, stdout);
+
+    // Reduce the per-phase timers and message counters, print them on rank 0 and append the
+    // run report to $PPM_REPORT
+    ppm_laplace_report(&solver, "rma");
+
+    ppm_laplace_finalize(&solver);
+
+    MPI_Finalize();
+}
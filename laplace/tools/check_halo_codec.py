@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Halo Compression Check
+
+Runs blocking_laplace.exe and the fire simulator once per halo codec (PPM_HALO_CODEC, see
+TOOLS.md) and compares every run against the uncompressed one:
+
+- Laplace: final error, |error - reference| <= --tolerance
+- Fire:    iteration count must match and every `Result:` value must satisfy
+           |value - reference| <= --fire-tolerance * max(1, |reference|)
+- delta is lossless, so it must reproduce the reference exactly
+
+For each run it also prints the bytes sent (from the run report), the saving against the
+uncompressed run and the time spent packing/unpacking next to the halo time, so the bandwidth
+gain can be weighed against the codec cost. Exits with 1 if any codec is out of tolerance.
+
+Usage:
+    python3 tools/check_halo_codec.py [--np 4] [--grid 1024 1024] [--iterations 500]
+                                      [--codecs bf16 fp16 delta] [--tolerance 1e-3]
+                                      [--fire-tolerance 1e-2] [--fire-args "..."]
+"""
+
+import argparse
+import json
+import os
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+LAPLACE_DIR = Path(__file__).resolve().parent.parent
+FIRE_DIR = LAPLACE_DIR.parent / "fire-simulator"
+
+# 200 x 200 surface, 3 teams and 4 focal points spread over all row slabs
+DEFAULT_FIRE_ARGS = (
+    "200 200 300 3 10 10 1 100 190 2 190 100 3 "
+    "4 20 20 0 1000 60 150 5 800 120 40 10 900 180 180 20 700"
+)
+
+
+def run(command, codec):
+    """Run one solver with the given codec, return (stdout, run report dict)."""
+    with tempfile.TemporaryDirectory() as tmp:
+        report = Path(tmp) / "report.json"
+        env = dict(os.environ, PPM_HALO_CODEC=codec, PPM_REPORT=str(report))
+        result = subprocess.run(command, env=env, capture_output=True, text=True)
+        if not report.exists():
+            print(result.stdout + result.stderr)
+            sys.exit(f"Error: {' '.join(command)} wrote no run report")
+        return result.stdout, json.loads(report.read_text().splitlines()[-1])
+
+
+def fire_result(stdout):
+    match = re.search(r"^Result: (\d+)((?: \S+)*)$", stdout, re.MULTILINE)
+    if match is None:
+        sys.exit("Error: the fire simulator printed no Result line")
+    return int(match.group(1)), [float(v) for v in match.group(2).split()]
+
+
+def print_row(solver, codec, report, reference, deviation, ok):
+    saving = 100.0 * (1.0 - report["bytes_sent"] / reference["bytes_sent"])
+    pack = report["phases"]["pack"]["avg"]
+    halo = report["phases"]["halo"]["avg"]
+    print(
+        f"{solver:<8} {codec:<6} {deviation:<12.3e} {report['bytes_sent']:<12.0f} "
+        f"{saving:<8.1f} {pack:<10.4f} {halo:<10.4f} {'ok' if ok else 'FAIL'}"
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Validate and measure halo compression")
+    parser.add_argument("--np", type=int, default=4, help="MPI ranks")
+    parser.add_argument("--grid", type=int, nargs=2, default=[1024, 1024], metavar=("N", "M"))
+    parser.add_argument("--iterations", type=int, default=500)
+    parser.add_argument("--codecs", nargs="+", default=["bf16", "fp16", "delta"])
+    parser.add_argument("--tolerance", type=float, default=1e-3, help="Laplace error tolerance")
+    parser.add_argument(
+        "--fire-tolerance", type=float, default=1e-2, help="Fire Result relative tolerance"
+    )
+    parser.add_argument("--fire-args", default=DEFAULT_FIRE_ARGS, help="Fire scenario arguments")
+    parser.add_argument("--mpirun", default="mpirun")
+    parser.add_argument("--mpirun-args", default="--oversubscribe")
+    args = parser.parse_args()
+
+    subprocess.run(["make", "-C", str(LAPLACE_DIR), "blocking_laplace.exe"], check=True)
+    subprocess.run(["make", "-C", str(FIRE_DIR), "mpi_extinguishing.exe"], check=True)
+
+    mpirun = [args.mpirun, "-np", str(args.np)] + shlex.split(args.mpirun_args)
+    laplace = mpirun + [
+        str(LAPLACE_DIR / "executables" / "blocking_laplace.exe"),
+        str(args.grid[0]),
+        str(args.grid[1]),
+        str(args.iterations),
+    ]
+    fire = mpirun + [str(FIRE_DIR / "executables" / "mpi_extinguishing.exe")]
+    fire += shlex.split(args.fire_args)
+
+    failures = 0
+    print(f"{'solver':<8} {'codec':<6} {'deviation':<12} {'bytes':<12} {'saved%':<8} "
+          f"{'pack_s':<10} {'halo_s':<10} status")
+
+    _, reference = run(laplace, "none")
+    print_row("laplace", "none", reference, reference, 0.0, True)
+    for codec in args.codecs:
+        _, report = run(laplace, codec)
+        deviation = abs(report["error"] - reference["error"])
+        ok = deviation == 0.0 if codec == "delta" else deviation <= args.tolerance
+        failures += not ok
+        print_row("laplace", codec, report, reference, deviation, ok)
+
+    stdout, fire_reference = run(fire, "none")
+    ref_iterations, ref_values = fire_result(stdout)
+    print_row("fire", "none", fire_reference, fire_reference, 0.0, True)
+    for codec in args.codecs:
+        stdout, report = run(fire, codec)
+        iterations, values = fire_result(stdout)
+        deviation = max(
+            (abs(v - r) / max(1.0, abs(r)) for v, r in zip(values, ref_values)), default=0.0
+        )
+        if codec == "delta":
+            ok = iterations == ref_iterations and values == ref_values
+        else:
+            ok = iterations == ref_iterations and deviation <= args.fire_tolerance
+        failures += not ok
+        print_row("fire", codec, report, fire_reference, deviation, ok)
+
+    if failures:
+        print(f"\n{failures} codec run(s) out of tolerance")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,393 @@
+#!/usr/bin/env python3
+"""
+Results Dashboard
+
+Builds one self-contained HTML page (inline SVG and CSS, no network access needed to view it)
+from any number of run reports. It shows how the solvers scale and how that changed from
+commit to commit:
+
+- Inputs: run report files of PPM_REPORT (CSV or JSON Lines, one row per run with variant,
+  precision, machine, commit and timestamp), or directories searched recursively for them,
+  e.g. the raw/ reports of tools/run_benchmarks.py. Aggregated <variant>_<scaling>.csv files
+  without a commit column, such as data/output/blocking_strong.csv, are read as one version
+  named --label
+- Series: runs of the same variant, precision, machine and scaling type. Strong scaling series
+  are also split by grid. A run is weak scaling when its path has a "weak" directory or
+  ends in _weak.csv
+- Versions: commits, ordered by their first run. Repeats of a point are averaged
+- Charts per series: total time, speedup (strong) or efficiency (weak) and comm percent
+  against processors, one line per version, plus the history of total time per processor
+  count across versions
+- Regressions: a point whose mean total_time grew by more than --threshold percent from the
+  previous version of its series, and by more than both 95% confidence intervals, is flagged
+  (the rule of run_benchmarks.py --compare). Improvements are listed too
+
+Usage:
+    python3 tools/dashboard.py data/output data/benchmarks/raw [--output data/dashboard.html]
+                               [--threshold 10] [--label stored] [--fail-on-regression]
+"""
+
+import argparse
+import csv
+import html
+import json
+import math
+import sys
+from pathlib import Path
+
+from run_benchmarks import mean_std_ci
+
+METRICS = ["total_time", "comm_time", "comp_time"]
+
+# Line colours, one per version (cycled)
+COLORS = [
+    "#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd",
+    "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf",
+]
+
+STYLE = """
+body { font-family: sans-serif; margin: 2em; color: #222; max-width: 1400px; }
+h1 { margin-bottom: 0.2em; }
+h2 { border-bottom: 1px solid #ccc; padding-bottom: 0.2em; margin-top: 2em; }
+table { border-collapse: collapse; margin: 1em 0; font-size: 0.9em; }
+th, td { border: 1px solid #ccc; padding: 0.3em 0.6em; text-align: right; }
+th { background: #f0f0f0; }
+td.text { text-align: left; }
+tr.regression td { background: #fbdada; }
+tr.improvement td { background: #dcf3dc; }
+.charts { display: flex; flex-wrap: wrap; gap: 1em; }
+.summary { color: #555; }
+svg text { font-size: 11px; font-family: sans-serif; }
+"""
+
+
+def scaling_of(path):
+    """'weak' for the reports of weak scaling runs, else 'strong'."""
+    if "weak" in path.parent.parts or path.stem.endswith("_weak"):
+        return "weak"
+    return "strong"
+
+
+def read_rows(path):
+    """Rows of a CSV or JSON Lines file as dicts; [] if it is neither."""
+    try:
+        if path.suffix in (".json", ".jsonl"):
+            with open(path) as f:
+                return [json.loads(line) for line in f if line.strip()]
+        with open(path, newline="") as f:
+            return list(csv.DictReader(f))
+    except (OSError, ValueError, csv.Error):
+        return []
+
+
+def load_runs(paths, label):
+    """Return the runs of all reports below 'paths' as normalized dicts."""
+    files = []
+    for path in map(Path, paths):
+        if path.is_dir():
+            files += sorted(p for p in path.rglob("*") if p.suffix in (".csv", ".json", ".jsonl"))
+        elif path.exists():
+            files.append(path)
+        else:
+            print(f"  Warning: {path} does not exist, skipped")
+
+    runs = []
+    for path in files:
+        rows = read_rows(path)
+        if not rows or not all(k in rows[0] for k in ["processors", *METRICS]):
+            continue
+        scaling = scaling_of(path)
+        if "commit" not in rows[0]:
+            # Aggregated <variant>_<scaling>.csv: the variant comes from the name
+            stem = path.stem.rsplit("_", 1)
+            if len(stem) != 2 or stem[1] not in ("strong", "weak"):
+                continue
+            for row in rows:
+                row.update(variant=stem[0], commit=label, timestamp="")
+        for row in rows:
+            try:
+                run = {
+                    "variant": row["variant"],
+                    "precision": row.get("precision") or "float",
+                    "machine": row.get("machine") or "unknown",
+                    "commit": row["commit"],
+                    "timestamp": row.get("timestamp") or "",
+                    "scaling": scaling,
+                    "processors": int(row["processors"]),
+                    "nodes": int(row.get("nodes") or 1),
+                    "grid": f"{row['rows']}x{row['columns']}" if row.get("rows") else "",
+                }
+                for metric in METRICS:
+                    run[metric] = float(row[metric])
+            except (KeyError, ValueError):
+                continue
+            runs.append(run)
+    return runs
+
+
+def series_key(run):
+    """Runs comparable across processors: weak series span grids, strong ones do not."""
+    grid = run["grid"] if run["scaling"] == "strong" else ""
+    return (run["variant"], run["precision"], run["machine"], run["scaling"], grid)
+
+
+def series_name(key):
+    variant, precision, machine, scaling, grid = key
+    name = f"{variant} ({precision}) {scaling} scaling on {machine}"
+    return f"{name}, {grid}" if grid else name
+
+
+def version_order(runs):
+    """Commits ordered by their first run; versions without timestamps come first."""
+    first = {}
+    for run in runs:
+        stamp = run["timestamp"]
+        if run["commit"] not in first or stamp < first[run["commit"]]:
+            first[run["commit"]] = stamp
+    return sorted(first, key=lambda commit: (first[commit], commit))
+
+
+def aggregate(runs):
+    """Return {series: {commit: {processors: point}}} with mean, std and CI per metric."""
+    grouped = {}
+    for run in runs:
+        points = grouped.setdefault(series_key(run), {}).setdefault(run["commit"], {})
+        points.setdefault(run["processors"], []).append(run)
+
+    series = {}
+    for key, versions in grouped.items():
+        for commit, points in versions.items():
+            for processors, group in points.items():
+                point = {"repeats": len(group), "nodes": max(r["nodes"] for r in group)}
+                for metric in METRICS:
+                    mean, std, ci = mean_std_ci([r[metric] for r in group])
+                    point[metric], point[f"{metric}_std"], point[f"{metric}_ci95"] = mean, std, ci
+                point["comm_percent"] = point["comm_time"] / point["total_time"] * 100
+                series.setdefault(key, {}).setdefault(commit, {})[processors] = point
+
+    # Speedup and efficiency against the smallest processor count of each version
+    for key, versions in series.items():
+        for points in versions.values():
+            base_p = min(points)
+            base_t = points[base_p]["total_time"]
+            for processors, point in points.items():
+                point["speedup"] = base_t / point["total_time"]
+                if key[3] == "strong":
+                    point["efficiency"] = point["speedup"] / (processors / base_p) * 100
+                else:
+                    point["efficiency"] = point["speedup"] * 100
+    return series
+
+
+def find_changes(series, order, threshold):
+    """Return [(series, processors, old commit, new commit, old, new, change %, regression)] for
+    points that moved by more than 'threshold' percent and the confidence intervals."""
+    changes = []
+    for key, versions in sorted(series.items()):
+        commits = [c for c in order if c in versions]
+        for old_commit, new_commit in zip(commits, commits[1:]):
+            for processors, new in sorted(versions[new_commit].items()):
+                old = versions[old_commit].get(processors)
+                if old is None:
+                    continue
+                delta = new["total_time"] - old["total_time"]
+                change = delta / old["total_time"] * 100
+                margin = new["total_time_ci95"] + old["total_time_ci95"]
+                if abs(change) > threshold and abs(delta) > margin:
+                    changes.append((key, processors, old_commit, new_commit, old["total_time"],
+                                    new["total_time"], change, change > 0))
+    return changes
+
+
+def svg_chart(title, lines, x_label, y_label, x_labels=None, ideal=None):
+    """Line chart as inline SVG. 'lines' is [(label, colour, [(x, y)])]; with 'x_labels' the
+    x values are indices into it (categorical axis), else processor counts on a log2 axis.
+    'ideal' adds a dashed reference line [(x, y)]."""
+    width, height = 420, 280
+    left, right, top, bottom = 55, 15, 30, 45
+    plot_w, plot_h = width - left - right, height - top - bottom
+
+    xs = [x for _, _, points in lines for x, _ in points]
+    ys = [y for _, _, points in lines for _, y in points] + [y for _, y in ideal or []]
+    if not xs:
+        return ""
+    log_x = x_labels is None and min(xs) > 0
+    fx = (lambda x: math.log2(x)) if log_x else float
+    x_min, x_max = fx(min(xs)), fx(max(xs))
+    if x_max == x_min:
+        x_min, x_max = x_min - 1, x_max + 1
+    y_min, y_max = 0.0, max(ys) * 1.1 if max(ys) > 0 else 1.0
+
+    def px(x):
+        return left + (fx(x) - x_min) / (x_max - x_min) * plot_w
+
+    def py(y):
+        return top + plot_h - (y - y_min) / (y_max - y_min) * plot_h
+
+    out = [f'<svg width="{width}" height="{height}" xmlns="http://www.w3.org/2000/svg">']
+    out.append(f'<text x="{width / 2}" y="16" text-anchor="middle" font-weight="bold">'
+               f"{html.escape(title)}</text>")
+    # Axes, grid and ticks
+    for i in range(5):
+        y = y_min + (y_max - y_min) * i / 4
+        out.append(f'<line x1="{left}" y1="{py(y):.1f}" x2="{left + plot_w}" y2="{py(y):.1f}" '
+                   'stroke="#e5e5e5"/>')
+        out.append(f'<text x="{left - 5}" y="{py(y) + 4:.1f}" text-anchor="end">{y:.3g}</text>')
+    for x in sorted(set(xs)):
+        text = x_labels[x] if x_labels is not None else str(x)
+        out.append(f'<text x="{px(x):.1f}" y="{top + plot_h + 15}" text-anchor="middle">'
+                   f"{html.escape(text[:10])}</text>")
+    out.append(f'<rect x="{left}" y="{top}" width="{plot_w}" height="{plot_h}" fill="none" '
+               'stroke="#999"/>')
+    out.append(f'<text x="{left + plot_w / 2}" y="{height - 8}" text-anchor="middle">'
+               f"{html.escape(x_label)}</text>")
+    out.append(f'<text x="14" y="{top + plot_h / 2}" text-anchor="middle" '
+               f'transform="rotate(-90 14 {top + plot_h / 2})">{html.escape(y_label)}</text>')
+
+    if ideal:
+        path = " ".join(f"{px(x):.1f},{py(y):.1f}" for x, y in sorted(ideal))
+        out.append(f'<polyline points="{path}" fill="none" stroke="#999" '
+                   'stroke-dasharray="4 3"/>')
+    for label, color, points in lines:
+        points = sorted(points)
+        path = " ".join(f"{px(x):.1f},{py(y):.1f}" for x, y in points)
+        out.append(f'<polyline points="{path}" fill="none" stroke="{color}" stroke-width="2"/>')
+        for x, y in points:
+            out.append(f'<circle cx="{px(x):.1f}" cy="{py(y):.1f}" r="3" fill="{color}">'
+                       f"<title>{html.escape(label)}: {y:.4g}</title></circle>")
+    # Legend, top left inside the plot
+    for i, (label, color, _) in enumerate(lines[:8]):
+        y = top + 12 + i * 14
+        out.append(f'<rect x="{left + 6}" y="{y - 8}" width="10" height="3" fill="{color}"/>')
+        out.append(f'<text x="{left + 20}" y="{y - 3}">{html.escape(label[:24])}</text>')
+    out.append("</svg>")
+    return "\n".join(out)
+
+
+def series_section(key, versions, order, changes):
+    commits = [c for c in order if c in versions]
+    colors = {c: COLORS[i % len(COLORS)] for i, c in enumerate(commits)}
+    strong = key[3] == "strong"
+
+    def lines(metric):
+        return [(c, colors[c], [(p, pt[metric]) for p, pt in versions[c].items()]) for c in commits]
+
+    processors = sorted({p for c in commits for p in versions[c]})
+    base = processors[0]
+    charts = [svg_chart("Total time", lines("total_time"), "processors", "seconds")]
+    if strong:
+        ideal = [(p, p / base) for p in processors]
+        charts.append(svg_chart("Speedup", lines("speedup"), "processors", "speedup",
+                                ideal=ideal))
+    charts.append(svg_chart("Efficiency", lines("efficiency"), "processors", "%",
+                            ideal=[(p, 100.0) for p in processors]))
+    charts.append(svg_chart("Comm percent", lines("comm_percent"), "processors", "%"))
+    if len(commits) > 1:
+        history = [
+            (f"{p} procs", COLORS[i % len(COLORS)],
+             [(j, versions[c][p]["total_time"]) for j, c in enumerate(commits) if p in versions[c]])
+            for i, p in enumerate(processors)
+        ]
+        charts.append(svg_chart("Total time by version", history, "version", "seconds",
+                                x_labels=commits))
+
+    out = [f"<h2>{html.escape(series_name(key))}</h2>", '<div class="charts">']
+    out += [c for c in charts if c]
+    out.append("</div>")
+
+    # Table of the latest version, with the change against the previous one
+    latest = commits[-1]
+    previous = versions[commits[-2]] if len(commits) > 1 else {}
+    flagged = {(c[1], c[3]): c[7] for c in changes if c[0] == key}
+    out.append(f"<p class=\"summary\">Latest version {html.escape(latest)}"
+               f"{f', compared with {html.escape(commits[-2])}' if previous else ''}:</p>")
+    columns = ["processors", "nodes", "total_time", "comm_time", "comp_time", "comm_percent"]
+    columns += ["speedup", "efficiency"] if strong else ["efficiency"]
+    columns += ["repeats", "change %"]
+    out.append("<table><tr>" + "".join(f"<th>{c}</th>" for c in columns) + "</tr>")
+    for p in sorted(versions[latest]):
+        point = versions[latest][p]
+        cells = [str(p), str(point["nodes"])]
+        cells += [f"{point[m]:.4f}" for m in METRICS]
+        cells.append(f"{point['comm_percent']:.2f}")
+        if strong:
+            cells.append(f"{point['speedup']:.2f}")
+        cells.append(f"{point['efficiency']:.2f}")
+        cells.append(str(point["repeats"]))
+        old = previous.get(p)
+        cells.append(f"{(point['total_time'] - old['total_time']) / old['total_time'] * 100:+.2f}"
+                     if old else "")
+        flag = flagged.get((p, latest))
+        css = "" if flag is None else (' class="regression"' if flag else ' class="improvement"')
+        out.append(f"<tr{css}>" + "".join(f"<td>{c}</td>" for c in cells) + "</tr>")
+    out.append("</table>")
+    return "\n".join(out)
+
+
+def changes_table(changes, threshold):
+    if not changes:
+        return (f"<p>No point moved by more than {threshold:.1f}% beyond its confidence "
+                "interval.</p>")
+    out = ["<table><tr><th>Series</th><th>Processors</th><th>From</th><th>To</th>"
+           "<th>Before (s)</th><th>After (s)</th><th>Change %</th><th></th></tr>"]
+    for key, processors, old_commit, new_commit, old, new, change, regression in changes:
+        css = "regression" if regression else "improvement"
+        out.append(
+            f'<tr class="{css}"><td class="text">{html.escape(series_name(key))}</td>'
+            f"<td>{processors}</td><td class=\"text\">{html.escape(old_commit)}</td>"
+            f"<td class=\"text\">{html.escape(new_commit)}</td><td>{old:.4f}</td>"
+            f"<td>{new:.4f}</td><td>{change:+.2f}</td>"
+            f"<td class=\"text\">{'REGRESSION' if regression else 'improvement'}</td></tr>"
+        )
+    out.append("</table>")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("inputs", nargs="+", help="Run report files or directories")
+    parser.add_argument("--output", default="data/dashboard.html")
+    parser.add_argument("--threshold", type=float, default=10.0, help="Regression threshold %%")
+    parser.add_argument("--label", default="stored", help="Version name of aggregated CSVs")
+    parser.add_argument(
+        "--fail-on-regression", action="store_true", help="Exit with 1 if any point regressed"
+    )
+    args = parser.parse_args()
+
+    runs = load_runs(args.inputs, args.label)
+    if not runs:
+        print(f"Error: no run reports found in {' '.join(args.inputs)}")
+        sys.exit(1)
+    order = version_order(runs)
+    series = aggregate(runs)
+    changes = find_changes(series, order, args.threshold)
+    regressions = sum(1 for c in changes if c[7])
+
+    body = [
+        "<h1>Laplace and fire simulator results</h1>",
+        f'<p class="summary">{len(runs)} runs, {len(series)} series, {len(order)} versions '
+        f"({html.escape(', '.join(order))}), {regressions} regression(s) at a "
+        f"{args.threshold:.1f}% threshold.</p>",
+        "<h2>Changes between versions</h2>",
+        changes_table(changes, args.threshold),
+    ]
+    for key in sorted(series):
+        body.append(series_section(key, series[key], order, changes))
+
+    output = Path(args.output)
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text(
+        "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Results dashboard</title>"
+        f"<style>{STYLE}</style></head><body>\n" + "\n".join(body) + "\n</body></html>\n"
+    )
+    print(f"  Created: {output} ({len(runs)} runs, {len(series)} series, {len(order)} versions)")
+    for key, processors, old_commit, new_commit, old, new, change, regression in changes:
+        if regression:
+            print(f"  REGRESSION {series_name(key)}, {processors} procs: {old_commit} "
+                  f"{old:.4f}s -> {new_commit} {new:.4f}s ({change:+.2f}%)")
+    if args.fail_on_regression and regressions:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,321 @@
+#!/usr/bin/env python3
+"""
+Scaling Predictor for the Laplace MPI Solvers
+
+Predicts total, comm and comp time of every point of a benchmark matrix for each exchange
+variant before the cluster is booked, from two microbenchmark outputs:
+
+- kernel_bench.exe CSV: seconds per grid point of the stencil (--kernel, default heat/fused,
+  the fused sweep + residual of ../libppm/ppm_stencil.c) as a function of the working set,
+  interpolated log-log between the measured sizes
+- halo_bench.exe CSV:   latency and bandwidth of one halo exchange per strategy (least-squares
+  fit of time = latency + bytes / bandwidth at the largest rank count measured) and the
+  MPI_Allreduce time as a + b * log2(ranks)
+
+Per iteration, the slowest rank sweeps ceil(rows / ranks) x (columns - 2) points over a
+working set of two local grids, and spends one halo exchange of one row plus one
+MPI_Allreduce. The exchange strategies map to the halo_bench variants as blocking -> sendrecv,
+nonblocking -> isend and rma -> rma_pscw. shm pays no exchange on one node and a sendrecv
+between nodes. Ranks of one node share its memory bandwidth (--node-gbytes-per-s). Exchanges
+between nodes use --internode-latency-us / --internode-gbytes-per-s when given. Otherwise
+they use the on-node fit. --startup-seconds adds the fixed cost of a run (MPI_Init, TAU) to
+comp, as the measured total_time includes it.
+
+Writes <variant>_<scaling>.csv files with the columns of data/output/blocking_strong.csv
+(processors,nodes,total_time,comm_time,comp_time,comm_percent,speedup,efficiency; weak files
+without speedup). With --validate DIR, every prediction with a measured counterpart in
+DIR/<variant>_<scaling>.csv is compared against it, printing the error per point and the mean
+absolute percentage error per file. --anchor scales comp and comm of each series so that its
+first point matches the measurement. The remaining points then test how well the model
+extrapolates from one measured node.
+
+Usage:
+    python3 tools/predict_scaling.py --kernel-csv data/model/kernel.csv
+                                     --halo-csv data/model/halo.csv
+                                     [--matrix tools/matrices/cluster.json] [--variants ...]
+                                     [--ranks-per-node 12] [--node-gbytes-per-s 40]
+                                     [--internode-latency-us 2 --internode-gbytes-per-s 10]
+                                     [--startup-seconds 1.5]
+                                     [--output data/predictions] [--validate data/output]
+                                     [--anchor]
+"""
+
+import argparse
+import csv
+import json
+import math
+import sys
+from pathlib import Path
+
+# Exchange variant -> halo_bench.exe variant of its halo exchange (None: read in place)
+HALO_VARIANTS = {"blocking": "sendrecv", "nonblocking": "isend", "rma": "rma_pscw", "shm": None}
+
+# Element size of the float build
+ELEMENT_BYTES = 4
+
+
+def read_kernel(path, kernel):
+    """Return [(working set bytes, seconds per point, bytes per point)] of one kernel variant,
+    sorted by working set."""
+    name, variant = kernel.split("/")
+    rows = []
+    with open(path, newline="") as f:
+        for row in csv.DictReader(line for line in f if not line.startswith("#")):
+            if row["kernel"] != name or row["variant"] != variant:
+                continue
+            glups = float(row["glups"])
+            working_set = int(row["working_set_kib"]) * 1024
+            rows.append((working_set, 1e-9 / glups, float(row["gbytes_per_s"]) / glups))
+    if not rows:
+        sys.exit(f"Error: no {kernel} rows in {path}")
+    return sorted(rows)
+
+
+def point_seconds(kernel_rows, working_set):
+    """Seconds per point at 'working_set' bytes, log-log interpolated, clamped at the ends."""
+    if working_set <= kernel_rows[0][0]:
+        return kernel_rows[0][1]
+    for (w0, t0, _), (w1, t1, _) in zip(kernel_rows, kernel_rows[1:]):
+        if working_set <= w1:
+            x = (math.log(working_set) - math.log(w0)) / (math.log(w1) - math.log(w0))
+            return math.exp(math.log(t0) + x * (math.log(t1) - math.log(t0)))
+    return kernel_rows[-1][1]
+
+
+def fit_line(points):
+    """Least-squares (intercept, slope) of [(x, y)]; slope 0 for a single x."""
+    n = len(points)
+    mean_x = sum(x for x, _ in points) / n
+    mean_y = sum(y for _, y in points) / n
+    sxx = sum((x - mean_x) ** 2 for x, _ in points)
+    if sxx == 0:
+        return mean_y, 0.0
+    slope = sum((x - mean_x) * (y - mean_y) for x, y in points) / sxx
+    return mean_y - slope * mean_x, slope
+
+
+def read_halo(path):
+    """Return ({halo variant: (latency s, seconds per byte)}, (allreduce a, b per log2 rank))."""
+    rows = []
+    with open(path, newline="") as f:
+        for row in csv.DictReader(line for line in f if not line.startswith("#")):
+            rows.append(row)
+    if not rows:
+        sys.exit(f"Error: no rows in {path}")
+
+    exchanges = {}
+    for variant in {r["variant"] for r in rows} - {"allreduce"}:
+        ranks = max(int(r["ranks"]) for r in rows if r["variant"] == variant)
+        points = [
+            (float(r["bytes"]), float(r["time_us_avg"]) * 1e-6)
+            for r in rows
+            if r["variant"] == variant and int(r["ranks"]) == ranks
+        ]
+        latency, per_byte = fit_line(points)
+        exchanges[variant] = (max(latency, 0.0), max(per_byte, 0.0))
+
+    reduce_points = [
+        (math.log2(int(r["ranks"])), float(r["time_us_avg"]) * 1e-6)
+        for r in rows
+        if r["variant"] == "allreduce"
+    ]
+    if not reduce_points:
+        sys.exit(f"Error: no allreduce rows in {path}")
+    a, b = fit_line(reduce_points)
+    return exchanges, (max(a, 0.0), max(b, 0.0))
+
+
+def predict(point, iterations, variant, model, args):
+    """Return (comp, comm) seconds of the slowest rank for one matrix point."""
+    ranks, nodes = point["ranks"], point["nodes"]
+    rows, columns = point["rows"], point["columns"]
+    local_rows = math.ceil(rows / ranks)
+    interior = local_rows * (columns - 2)
+
+    # Two local grids of local_rows + 2 rows stay resident between sweeps
+    working_set = 2 * (local_rows + 2) * columns * ELEMENT_BYTES
+    seconds = point_seconds(model["kernel"], working_set)
+    if args.node_gbytes_per_s:
+        bytes_per_point = model["kernel"][-1][2]
+        ranks_per_node = min(ranks, args.ranks_per_node)
+        seconds = max(seconds, bytes_per_point * ranks_per_node / (args.node_gbytes_per_s * 1e9))
+    comp = args.startup_seconds + iterations * interior * seconds
+
+    halo = HALO_VARIANTS[variant]
+    if halo is None:
+        halo = "sendrecv" if nodes > 1 else None
+    exchange = 0.0
+    if halo is not None and ranks > 1:
+        if halo not in model["halo"]:
+            sys.exit(f"Error: no {halo} rows in the halo benchmark CSV")
+        latency, per_byte = model["halo"][halo]
+        if nodes > 1 and args.internode_latency_us is not None:
+            latency = args.internode_latency_us * 1e-6
+        if nodes > 1 and args.internode_gbytes_per_s is not None:
+            per_byte = 1.0 / (args.internode_gbytes_per_s * 1e9)
+        exchange = latency + columns * ELEMENT_BYTES * per_byte
+    a, b = model["reduce"]
+    reduce = a + b * math.log2(ranks) if ranks > 1 else 0.0
+    return comp, iterations * (exchange + reduce)
+
+
+def read_measured(path):
+    """Return {processors: row} of a measured scaling CSV, or None if it does not exist."""
+    if not path.exists():
+        return None
+    with open(path, newline="") as f:
+        return {int(r["processors"]): r for r in csv.DictReader(f)}
+
+
+def write_series(path, scaling, entries):
+    """Write one prediction CSV; 'entries' are (point, comp, comm) in matrix order."""
+    fieldnames = ["processors", "nodes", "total_time", "comm_time", "comp_time", "comm_percent"]
+    fieldnames += ["speedup", "efficiency"] if scaling == "strong" else ["efficiency"]
+    base_ranks = entries[0][0]["ranks"]
+    base_total = entries[0][1] + entries[0][2]
+    with open(path, "w", newline="") as csvfile:
+        writer = csv.DictWriter(csvfile, fieldnames=fieldnames)
+        writer.writeheader()
+        for point, comp, comm in entries:
+            total = comp + comm
+            row = {
+                "processors": point["ranks"],
+                "nodes": point["nodes"],
+                "total_time": f"{total:.4f}",
+                "comm_time": f"{comm:.4f}",
+                "comp_time": f"{comp:.4f}",
+                "comm_percent": f"{comm / total * 100:.2f}",
+            }
+            speedup = base_total / total
+            if scaling == "strong":
+                row["speedup"] = f"{speedup:.2f}"
+                row["efficiency"] = f"{speedup / (point['ranks'] / base_ranks) * 100:.2f}"
+            else:
+                row["efficiency"] = f"{speedup * 100:.2f}"
+            writer.writerow(row)
+    print(f"  Created: {path}")
+
+
+def validate(name, entries, measured):
+    """Print predicted against measured times per point; return the MAPE of total_time."""
+    print(f"\n{name}")
+    print(f"  {'Procs':<6} {'Total meas':>10} {'pred':>9} {'err %':>7}   "
+          f"{'Comm meas':>9} {'pred':>9}   {'Comp meas':>9} {'pred':>9}")
+    errors = []
+    for point, comp, comm in entries:
+        row = measured.get(point["ranks"])
+        if row is None:
+            continue
+        total = comp + comm
+        measured_total = float(row["total_time"])
+        error = (total - measured_total) / measured_total * 100
+        errors.append(abs(error))
+        print(f"  {point['ranks']:<6} {measured_total:>10.4f} {total:>9.4f} {error:>+7.1f}   "
+              f"{float(row['comm_time']):>9.4f} {comm:>9.4f}   "
+              f"{float(row['comp_time']):>9.4f} {comp:>9.4f}")
+    if not errors:
+        print("  No measured points in common")
+        return None
+    mape = sum(errors) / len(errors)
+    print(f"  MAPE total_time: {mape:.1f}% over {len(errors)} points")
+    return mape
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--kernel-csv", required=True, help="kernel_bench.exe output")
+    parser.add_argument("--halo-csv", required=True, help="halo_bench.exe output")
+    parser.add_argument("--kernel", default="heat/fused", help="kernel/variant of the sweep")
+    parser.add_argument("--matrix", default="tools/matrices/cluster.json")
+    parser.add_argument("--variants", nargs="+", help="Default: the variants of the matrix")
+    parser.add_argument(
+        "--ranks-per-node", type=int, help="Default: tasks_per_node of the matrix, else 12"
+    )
+    parser.add_argument(
+        "--node-gbytes-per-s", type=float, help="Memory bandwidth one node's ranks share"
+    )
+    parser.add_argument("--internode-latency-us", type=float)
+    parser.add_argument("--internode-gbytes-per-s", type=float)
+    parser.add_argument(
+        "--startup-seconds", type=float, default=0.0, help="Fixed cost per run, counted in comp"
+    )
+    parser.add_argument("--output", default="data/predictions")
+    parser.add_argument("--validate", help="Directory with measured <variant>_<scaling>.csv")
+    parser.add_argument(
+        "--anchor", action="store_true", help="Scale each series to its first measured point"
+    )
+    args = parser.parse_args()
+
+    with open(args.matrix) as f:
+        matrix = json.load(f)
+    if args.ranks_per_node is None:
+        args.ranks_per_node = matrix.get("slurm", {}).get("tasks_per_node", 12)
+    variants = args.variants or matrix["variants"]
+    unknown = [v for v in variants if v not in HALO_VARIANTS]
+    if unknown:
+        parser.error(
+            f"unknown variants: {' '.join(unknown)} (choose from {' '.join(HALO_VARIANTS)})"
+        )
+    if args.anchor and not args.validate:
+        parser.error("--anchor needs the measurements of --validate")
+
+    halo, reduce = read_halo(args.halo_csv)
+    model = {"kernel": read_kernel(args.kernel_csv, args.kernel), "halo": halo, "reduce": reduce}
+    output_dir = Path(args.output)
+    output_dir.mkdir(parents=True, exist_ok=True)
+
+    print("=" * 80)
+    fastest = min(t for _, t, _ in model["kernel"]) * 1e9
+    slowest = max(t for _, t, _ in model["kernel"]) * 1e9
+    print(f"Model: {args.kernel} {fastest:.3f}-{slowest:.3f} ns/point, "
+          f"allreduce {reduce[0] * 1e6:.2f} + {reduce[1] * 1e6:.2f} * log2(P) us")
+    for name, (latency, per_byte) in sorted(halo.items()):
+        bandwidth = f"{1e-9 / per_byte:.2f} GB/s" if per_byte > 0 else "unbounded"
+        print(f"       {name}: {latency * 1e6:.2f} us + bytes / {bandwidth}")
+    print("=" * 80)
+
+    mapes = []
+    for experiment in matrix["experiments"]:
+        scaling = experiment["scaling"]
+        for variant in variants:
+            entries = []
+            for point in experiment["points"]:
+                iterations = point.get("iterations", matrix["iterations"])
+                comp, comm = predict(point, iterations, variant, model, args)
+                entries.append((point, comp, comm))
+
+            name = f"{variant}_{scaling}.csv"
+            measured = read_measured(Path(args.validate) / name) if args.validate else None
+            if args.anchor and measured:
+                first = next((e for e in entries if e[0]["ranks"] in measured), None)
+                if first is not None:
+                    row = measured[first[0]["ranks"]]
+                    # The start-up cost is given, only the modelled part is scaled
+                    startup = args.startup_seconds
+                    comp_scale = (float(row["comp_time"]) - startup) / (first[1] - startup)
+                    comm_scale = float(row["comm_time"]) / first[2] if first[2] > 0 else 1.0
+                    entries = [
+                        (p, startup + (c - startup) * comp_scale, m * comm_scale)
+                        for p, c, m in entries
+                    ]
+                    print(f"  {name}: anchored at {first[0]['ranks']} ranks "
+                          f"(comp x {comp_scale:.3f}, comm x {comm_scale:.3f})")
+
+            write_series(output_dir / name, scaling, entries)
+            if measured:
+                mape = validate(name, entries, measured)
+                if mape is not None:
+                    mapes.append(mape)
+
+    if args.validate:
+        print("\n" + "=" * 80)
+        if mapes:
+            mean = sum(mapes) / len(mapes)
+            print(f"Validated {len(mapes)} series, mean MAPE of total_time {mean:.1f}%")
+        else:
+            print(f"No measurements in {args.validate} match the matrix")
+        print("=" * 80)
+
+
+if __name__ == "__main__":
+    main()
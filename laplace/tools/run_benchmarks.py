@@ -0,0 +1,466 @@
+#!/usr/bin/env python3
+"""
+Strong/Weak Scaling Benchmark Harness for the Laplace MPI Solvers
+
+Runs a matrix of {solver variant, grid, ranks, iterations} either on the local machine with
+an oversubscribed `mpirun` or on the cluster through SLURM, repeats every point N times and
+writes one CSV per variant and scaling type:
+
+- <variant>_strong.csv: processors,nodes,total_time,comm_time,comp_time,comm_percent,
+                        speedup,efficiency + repeats, std and 95% confidence intervals
+- <variant>_weak.csv:   same, without speedup
+
+The solvers write their own run reports (PPM_REPORT, see TOOLS.md), so nothing is parsed from
+text output. Matrices live in tools/matrices/ (cluster.json reproduces the 20-experiment study).
+
+With --perf every rank runs under `perf stat` and the CSVs gain the mean TLB counters of the
+point summed over ranks (dtlb_loads, dtlb_load_misses, dtlb_miss_percent, itlb_load_misses),
+e.g. to compare grid page sizes with --env PPM_HUGEPAGES=off against the default.
+
+With --tune-db the fastest halo strategy of every point (by mean time per iteration over the
+blocking, nonblocking, rma and shm variants run, per precision) is appended to the tuning
+database that auto_laplace.exe reads (../libppm/ppm_tune.h), so production runs skip the
+start-up calibration.
+
+Usage:
+    python3 tools/run_benchmarks.py [--matrix tools/matrices/local.json] [--backend local]
+                                    [--repeats N] [--output data/benchmarks]
+                                    [--compare data/benchmarks_old] [--threshold 10]
+                                    [--env KEY=VALUE ...] [--perf] [--tune-db data/tuning.csv]
+    python3 tools/run_benchmarks.py --backend slurm --matrix tools/matrices/cluster.json --wait
+    python3 tools/run_benchmarks.py --collect-only --output data/benchmarks
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import shlex
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+# Solver variants: name -> (makefile target, executable)
+VARIANTS = {
+    "blocking": ("blocking_laplace.exe", "executables/blocking_laplace.exe"),
+    "nonblocking": ("non_blocking_laplace.exe", "executables/non_blocking_laplace.exe"),
+    "rma": ("rma_laplace.exe", "executables/rma_laplace.exe"),
+    "shm": ("shm_laplace.exe", "executables/shm_laplace.exe"),
+    "auto": ("auto_laplace.exe", "executables/auto_laplace.exe"),
+}
+
+# Variants that run a single halo strategy, named as in ../libppm/ppm_slab.h
+HALO_STRATEGIES = ["blocking", "nonblocking", "rma", "shm"]
+
+TUNE_DB_FIELDS = [
+    "rows", "columns", "processors", "nodes", "precision", "halo", "seconds_per_iteration",
+    "source", "timestamp",
+]
+
+# Double and mixed precision builds of every variant: blocking_double, blocking_mixed, ...
+for _name, (_target, _executable) in list(VARIANTS.items()):
+    for _precision in ("double", "mixed"):
+        VARIANTS[f"{_name}_{_precision}"] = (
+            _target.replace(".exe", f"_{_precision}.exe"),
+            _executable.replace(".exe", f"_{_precision}.exe"),
+        )
+
+# Two-sided 95% Student-t quantiles by degrees of freedom (1.96 beyond the table)
+T_95 = {
+    1: 12.706, 2: 4.303, 3: 3.182, 4: 2.776, 5: 2.571, 6: 2.447, 7: 2.365, 8: 2.306,
+    9: 2.262, 10: 2.228, 12: 2.179, 15: 2.131, 20: 2.086, 25: 2.060, 30: 2.042,
+}
+
+METRICS = ["total_time", "comm_time", "comp_time"]
+
+# Hardware events collected with --perf and the CSV columns they end up in
+PERF_EVENTS = {
+    "dTLB-loads": "dtlb_loads",
+    "dTLB-load-misses": "dtlb_load_misses",
+    "iTLB-load-misses": "itlb_load_misses",
+}
+
+# Runs one rank under perf stat, writing $PPM_PERF_OUT.<rank> (Open MPI, MPICH or SLURM rank)
+PERF_WRAPPER = [
+    "sh",
+    "-c",
+    f"exec perf stat -x, -e {','.join(PERF_EVENTS)} "
+    '-o "$PPM_PERF_OUT.${OMPI_COMM_WORLD_RANK:-${PMI_RANK:-${SLURM_PROCID:-0}}}" "$@"',
+    "perf",
+]
+
+
+def t_quantile(dof):
+    """Return the 95% two-sided t quantile for the given degrees of freedom."""
+    if dof <= 0:
+        return 0.0
+    if dof > 30:
+        return 1.96
+    return T_95[max(d for d in T_95 if d <= dof)]
+
+
+def mean_std_ci(values):
+    """Return mean, sample standard deviation and 95% CI half-width of a list."""
+    n = len(values)
+    mean = sum(values) / n
+    if n < 2:
+        return mean, 0.0, 0.0
+    std = math.sqrt(sum((v - mean) ** 2 for v in values) / (n - 1))
+    return mean, std, t_quantile(n - 1) * std / math.sqrt(n)
+
+
+def report_path(raw_dir, variant, scaling, point):
+    """Run reports are stored as raw/<scaling>/<variant>/<ranks>p_<rows>x<columns>.csv"""
+    directory = raw_dir / scaling / variant
+    directory.mkdir(parents=True, exist_ok=True)
+    return directory / f"{point['ranks']}p_{point['rows']}x{point['columns']}.csv"
+
+
+def solver_command(variant, point, iterations, perf=False):
+    _, executable = VARIANTS[variant]
+    command = [executable, str(point["rows"]), str(point["columns"]), str(iterations)]
+    return PERF_WRAPPER + command if perf else command
+
+
+def run_local(matrix, raw_dir, mpirun, mpirun_args, extra_env, perf):
+    """Run every point of the matrix sequentially on this machine."""
+    for experiment in matrix["experiments"]:
+        scaling = experiment["scaling"]
+        for variant in matrix["variants"]:
+            for point in experiment["points"]:
+                report = report_path(raw_dir, variant, scaling, point)
+                env = dict(os.environ, PPM_REPORT=str(report), **extra_env)
+                iterations = point.get("iterations", matrix["iterations"])
+                cmd = (
+                    [mpirun]
+                    + mpirun_args
+                    + ["-np", str(point["ranks"])]
+                    + solver_command(variant, point, iterations, perf)
+                )
+
+                for rep in range(matrix["repeats"]):
+                    print(f"  [{rep + 1}/{matrix['repeats']}] {' '.join(cmd)}")
+                    env["PPM_PERF_OUT"] = f"{report}.perf.{rep + 1}"
+                    result = subprocess.run(cmd, env=env, stdout=subprocess.DEVNULL)
+                    if result.returncode != 0:
+                        print(f"  Error: {' '.join(cmd)} failed with exit code {result.returncode}")
+                        sys.exit(1)
+
+
+def slurm_script(matrix, variant, scaling, point, report, extra_env, perf):
+    """Build the SLURM job script that runs all repeats of one point."""
+    slurm = matrix.get("slurm", {})
+    iterations = point.get("iterations", matrix["iterations"])
+    tasks_per_node = slurm.get("tasks_per_node")
+    lines = [
+        "#!/bin/bash",
+        "",
+        f"#SBATCH --job-name=bench_{variant}_{scaling}_{point['ranks']}",
+        f"#SBATCH -N {point['nodes']} # number of nodes",
+        f"#SBATCH -n {point['ranks']} # number of cores/processes",
+        "#SBATCH --exclusive",
+        f"#SBATCH --partition={slurm.get('partition', 'nodo.q')}",
+        f"#SBATCH --output={report.with_suffix('.out')}",
+    ]
+    if tasks_per_node:
+        lines.append(f"#SBATCH --ntasks-per-node={min(tasks_per_node, point['ranks'])}")
+    lines.append("")
+    for module in slurm.get("modules", []):
+        lines.append(f"module load {module}")
+    lines += ["", f"export PPM_REPORT={report}"]
+    for key, value in extra_env.items():
+        lines.append(f"export {key}={shlex.quote(value)}")
+    lines.append("")
+    lines.append(f"for rep in $(seq {matrix['repeats']}); do")
+    cmd = " ".join(shlex.quote(c) for c in solver_command(variant, point, iterations, perf))
+    lines.append(f"    export PPM_PERF_OUT={report}.perf.$rep")
+    lines.append(f"    mpirun -np {point['ranks']} {cmd}")
+    lines.append("done")
+    return "\n".join(lines) + "\n"
+
+
+def run_slurm(matrix, raw_dir, wait, extra_env, perf):
+    """Submit one SLURM job per point; optionally wait for all of them to finish."""
+    jobs_dir = raw_dir.parent / "jobs"
+    jobs_dir.mkdir(parents=True, exist_ok=True)
+    job_ids = []
+
+    for experiment in matrix["experiments"]:
+        scaling = experiment["scaling"]
+        for variant in matrix["variants"]:
+            for point in experiment["points"]:
+                report = report_path(raw_dir, variant, scaling, point).resolve()
+                name = f"{variant}_{scaling}_{report.stem}"
+                script = jobs_dir / f"{name}.slurm"
+                script.write_text(
+                    slurm_script(matrix, variant, scaling, point, report, extra_env, perf)
+                )
+                out = subprocess.run(
+                    ["sbatch", "--parsable", str(script)], capture_output=True, text=True
+                )
+                if out.returncode != 0:
+                    print(f"  Error: sbatch {script} failed: {out.stderr.strip()}")
+                    sys.exit(1)
+                job_id = out.stdout.strip().split(";")[0]
+                job_ids.append(job_id)
+                print(f"  Submitted {name} as job {job_id}")
+
+    if not wait:
+        print("\nJobs submitted. When they finish, aggregate with:")
+        print(f"  python3 tools/run_benchmarks.py --collect-only --output {raw_dir.parent}")
+        sys.exit(0)
+
+    print("\nWaiting for jobs to finish...")
+    while True:
+        out = subprocess.run(
+            ["squeue", "-h", "-j", ",".join(job_ids)], capture_output=True, text=True
+        )
+        if not out.stdout.strip():
+            break
+        time.sleep(30)
+
+
+def read_perf(report):
+    """Return {column: [total over ranks per repeat]} from the perf stat files of a report."""
+    totals = {}
+    for path in report.parent.glob(f"{report.name}.perf.*.*"):
+        rep = int(path.name.split(".")[-2])
+        for line in path.read_text().splitlines():
+            fields = line.split(",")
+            if line.startswith("#") or len(fields) < 3 or fields[2] not in PERF_EVENTS:
+                continue
+            if not fields[0].isdigit():
+                continue  # <not supported> / <not counted>
+            column = totals.setdefault(PERF_EVENTS[fields[2]], {})
+            column[rep] = column.get(rep, 0) + int(fields[0])
+    return {column: [reps[r] for r in sorted(reps)] for column, reps in totals.items()}
+
+
+def read_reports(raw_dir):
+    """Group all run report rows by (variant, scaling, processors, rows, columns). Rows of runs
+    made with --perf also get the perf counters of their repeat."""
+    groups = {}
+    for report in sorted(raw_dir.glob("*/*/*.csv")):
+        scaling, variant = report.parent.parent.name, report.parent.name
+        perf = read_perf(report)
+        with open(report, newline="") as f:
+            for rep, row in enumerate(csv.DictReader(f)):
+                for column, values in perf.items():
+                    if rep < len(values):
+                        row[column] = values[rep]
+                key = (variant, scaling, int(row["processors"]), int(row["rows"]), int(row["columns"]))
+                groups.setdefault(key, []).append(row)
+    return groups
+
+
+def aggregate(groups, output_dir):
+    """Write <variant>_<scaling>.csv files with mean, std and 95% CI per point."""
+    series = {}
+    for key, rows in groups.items():
+        series.setdefault(key[:2], []).append((key, rows))
+
+    written = []
+    for (variant, scaling), points in sorted(series.items()):
+        points.sort(key=lambda p: p[0][2])
+        fieldnames = ["processors", "nodes", "total_time", "comm_time", "comp_time", "comm_percent"]
+        fieldnames += ["speedup", "efficiency"] if scaling == "strong" else ["efficiency"]
+        fieldnames += ["repeats", "rows", "columns"]
+        for metric in METRICS:
+            fieldnames += [f"{metric}_std", f"{metric}_ci95"]
+        perf_columns = [
+            c for c in PERF_EVENTS.values() if all(c in r for _, rows in points for r in rows)
+        ]
+        fieldnames += perf_columns
+        if "dtlb_loads" in perf_columns and "dtlb_load_misses" in perf_columns:
+            fieldnames.append("dtlb_miss_percent")
+
+        stats = []
+        for key, rows in points:
+            entry = {"processors": key[2], "rows": key[3], "columns": key[4], "repeats": len(rows)}
+            entry["nodes"] = max(int(r["nodes"]) for r in rows)
+            for metric in METRICS:
+                entry[metric], entry[f"{metric}_std"], entry[f"{metric}_ci95"] = mean_std_ci(
+                    [float(r[metric]) for r in rows]
+                )
+            for column in perf_columns:
+                entry[column] = sum(r[column] for r in rows) / len(rows)
+            stats.append(entry)
+
+        baseline = stats[0]
+        csv_path = output_dir / f"{variant}_{scaling}.csv"
+        with open(csv_path, "w", newline="") as csvfile:
+            writer = csv.DictWriter(csvfile, fieldnames=fieldnames)
+            writer.writeheader()
+            for entry in stats:
+                row = {k: entry[k] for k in ("processors", "nodes", "repeats", "rows", "columns")}
+                for metric in METRICS:
+                    for suffix in ("", "_std", "_ci95"):
+                        row[f"{metric}{suffix}"] = f"{entry[metric + suffix]:.4f}"
+                row["comm_percent"] = f"{entry['comm_time'] / entry['total_time'] * 100:.2f}"
+                for column in perf_columns:
+                    row[column] = f"{entry[column]:.0f}"
+                if "dtlb_miss_percent" in fieldnames:
+                    loads = entry["dtlb_loads"]
+                    row["dtlb_miss_percent"] = (
+                        f"{entry['dtlb_load_misses'] / loads * 100:.4f}" if loads else ""
+                    )
+                speedup = baseline["total_time"] / entry["total_time"]
+                if scaling == "strong":
+                    row["speedup"] = f"{speedup:.2f}"
+                    row["efficiency"] = (
+                        f"{speedup / (entry['processors'] / baseline['processors']) * 100:.2f}"
+                    )
+                else:
+                    row["efficiency"] = f"{speedup * 100:.2f}"
+                writer.writerow(row)
+        written.append(csv_path)
+        print(f"  Created: {csv_path}")
+
+    return written
+
+
+def compare(output_dir, baseline_dir, threshold):
+    """Flag points whose mean total time regressed by more than 'threshold' percent and by
+    more than the combined confidence intervals. Returns the number of regressions."""
+    regressions = 0
+    print(f"\n{'File':<26} {'Procs':<6} {'Base (s)':<12} {'New (s)':<12} {'Change %':<10}")
+    print("-" * 80)
+    for csv_path in sorted(output_dir.glob("*_*.csv")):
+        base_path = baseline_dir / csv_path.name
+        if not base_path.exists():
+            continue
+        with open(base_path, newline="") as f:
+            base = {int(r["processors"]): r for r in csv.DictReader(f)}
+        with open(csv_path, newline="") as f:
+            for row in csv.DictReader(f):
+                old = base.get(int(row["processors"]))
+                if old is None:
+                    continue
+                new_t, old_t = float(row["total_time"]), float(old["total_time"])
+                margin = float(row.get("total_time_ci95") or 0) + float(old.get("total_time_ci95") or 0)
+                change = (new_t - old_t) / old_t * 100
+                flag = ""
+                if change > threshold and new_t - old_t > margin:
+                    flag = "  <-- REGRESSION"
+                    regressions += 1
+                print(
+                    f"{csv_path.name:<26} {row['processors']:<6} {old_t:<12.4f} {new_t:<12.4f} "
+                    f"{change:<+10.2f}{flag}"
+                )
+    return regressions
+
+
+def write_tune_db(groups, path):
+    """Append the fastest halo strategy of every (grid, processors, nodes, precision) point to
+    the tuning database. Returns the number of rows written."""
+    best = {}
+    for (variant, _, processors, rows, columns), reports in groups.items():
+        halo = variant.rsplit("_", 1)[0] if variant.endswith(("_double", "_mixed")) else variant
+        if halo not in HALO_STRATEGIES:
+            continue
+        for nodes in {int(r["nodes"]) for r in reports}:
+            same = [r for r in reports if int(r["nodes"]) == nodes]
+            seconds = sum(float(r["total_time"]) / int(r["iterations"]) for r in same) / len(same)
+            key = (rows, columns, processors, nodes, same[0]["precision"])
+            if key not in best or seconds < best[key][1]:
+                best[key] = (halo, seconds)
+
+    path = Path(path)
+    new = not path.exists() or path.stat().st_size == 0
+    timestamp = time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime())
+    with open(path, "a", newline="") as f:
+        writer = csv.writer(f)
+        if new:
+            writer.writerow(TUNE_DB_FIELDS)
+        for key, (halo, seconds) in sorted(best.items()):
+            writer.writerow(list(key) + [halo, f"{seconds:.9f}", "benchmark", timestamp])
+            print(f"  {key[0]}x{key[1]} on {key[2]} ranks / {key[3]} nodes ({key[4]}): {halo}")
+    return len(best)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--matrix", default="tools/matrices/local.json")
+    parser.add_argument("--backend", choices=["local", "slurm"], default="local")
+    parser.add_argument("--repeats", type=int, help="Override the repeats of the matrix")
+    parser.add_argument("--output", default="data/benchmarks")
+    parser.add_argument("--mpirun", default="mpirun")
+    parser.add_argument(
+        "--mpirun-args", default="--oversubscribe", help="Extra mpirun arguments (local backend)"
+    )
+    parser.add_argument("--wait", action="store_true", help="Wait for SLURM jobs to finish")
+    parser.add_argument("--collect-only", action="store_true", help="Only aggregate reports")
+    parser.add_argument("--compare", help="Directory with baseline CSVs to check against")
+    parser.add_argument("--threshold", type=float, default=10.0, help="Regression threshold %%")
+    parser.add_argument(
+        "--env",
+        action="append",
+        default=[],
+        metavar="KEY=VALUE",
+        help="Environment variable for the solvers, e.g. PPM_HUGEPAGES=off (repeatable)",
+    )
+    parser.add_argument("--perf", action="store_true", help="Collect TLB counters with perf stat")
+    parser.add_argument(
+        "--tune-db", help="Append the fastest halo strategy per point to this tuning database"
+    )
+    args = parser.parse_args()
+
+    output_dir = Path(args.output)
+    raw_dir = output_dir / "raw"
+    if any("=" not in item for item in args.env):
+        parser.error("--env expects KEY=VALUE")
+    extra_env = dict(item.split("=", 1) for item in args.env)
+
+    if not args.collect_only:
+        with open(args.matrix) as f:
+            matrix = json.load(f)
+        if args.repeats:
+            matrix["repeats"] = args.repeats
+
+        targets = [VARIANTS[v][0] for v in matrix["variants"]]
+        subprocess.run(["make"] + targets, check=True)
+
+        # Start from a clean set of raw reports so repeats are not mixed across runs
+        raw_dir.mkdir(parents=True, exist_ok=True)
+        for report in raw_dir.glob("*/*/*.csv*"):
+            report.unlink()
+
+        print("=" * 80)
+        print(f"Running {args.matrix} ({args.backend} backend, {matrix['repeats']} repeats)")
+        print("=" * 80)
+        if args.backend == "local":
+            mpirun_args = shlex.split(args.mpirun_args)
+            run_local(matrix, raw_dir, args.mpirun, mpirun_args, extra_env, args.perf)
+        else:
+            run_slurm(matrix, raw_dir, args.wait, extra_env, args.perf)
+
+    print("\n" + "=" * 80)
+    print("Generating CSV files...")
+    groups = read_reports(raw_dir)
+    if not groups:
+        print(f"Error: no run reports found in {raw_dir}")
+        sys.exit(1)
+    aggregate(groups, output_dir)
+
+    if args.tune_db:
+        print(f"\nUpdating tuning database {args.tune_db}")
+        if not write_tune_db(groups, args.tune_db):
+            print("  No blocking, nonblocking, rma or shm runs to tune from")
+
+    if args.compare:
+        print("\n" + "=" * 80)
+        print(f"Comparing against {args.compare} (threshold {args.threshold:.1f}%)")
+        print("=" * 80)
+        regressions = compare(output_dir, Path(args.compare), args.threshold)
+        if regressions:
+            print(f"\n{regressions} performance regression(s) detected")
+            sys.exit(1)
+        print("\nNo performance regressions detected")
+
+    print("=" * 80)
+
+
+if __name__ == "__main__":
+    main()
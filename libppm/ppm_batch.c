@@ -0,0 +1,107 @@
+#include "ppm_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int ppm_batch_read(const char *path, ppm_problem_t **problems) {
+    FILE *file = fopen(path, "r");
+    ppm_problem_t *list = NULL, *grown;
+    char line[256], *text;
+    int count = 0, capacity = 0, line_number = 0, fields;
+
+    if (file == NULL) {
+        fprintf(stderr, "-- Error in batch: not found: %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0') continue;
+
+        if (count == capacity) {
+            capacity = capacity == 0 ? 64 : 2 * capacity;
+            grown = (ppm_problem_t *)realloc(list, sizeof(ppm_problem_t) * capacity);
+            if (grown == NULL) {
+                fprintf(stderr, "-- Error allocating: %d batch problems\n", capacity);
+                free(list);
+                fclose(file);
+                return -1;
+            }
+            list = grown;
+        }
+
+        fields = sscanf(text, "%d %d %d", &list[count].n, &list[count].m, &list[count].iter_max);
+        if (fields != 3 || list[count].n < 3 || list[count].m < 3 || list[count].iter_max < 0) {
+            fprintf(stderr, "-- Error in batch: %s:%d: expected \"n m iter_max\" with n, m >= 3\n",
+                    path, line_number);
+            free(list);
+            fclose(file);
+            return -1;
+        }
+        count++;
+    }
+    fclose(file);
+
+    *problems = list;
+    return count;
+}
+
+double ppm_problem_cost(const ppm_problem_t *problem) {
+    return (double)(problem->n - 2) * (problem->m - 2) * problem->iter_max;
+}
+
+typedef struct {
+    double cost;
+    int index;
+} ranked_problem_t;
+
+/* Decreasing cost, ties in input order so every rank computes the same schedule */
+static int by_decreasing_cost(const void *a, const void *b) {
+    const ranked_problem_t *x = a, *y = b;
+
+    if (x->cost != y->cost) return x->cost < y->cost ? 1 : -1;
+    return x->index - y->index;
+}
+
+double ppm_batch_schedule(const ppm_problem_t *problems, int count, const int *group_ranks,
+                          int groups, int *owner) {
+    ranked_problem_t *ranked = (ranked_problem_t *)malloc(sizeof(ranked_problem_t) * count);
+    double *load = (double *)calloc(groups, sizeof(double));
+    double finish, best_finish, makespan = 0.0;
+    int p, g, best;
+
+    if (ranked == NULL || load == NULL) {
+        fprintf(stderr, "-- Error allocating: batch schedule\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (p = 0; p < count; p++) {
+        ranked[p].cost = ppm_problem_cost(&problems[p]);
+        ranked[p].index = p;
+    }
+    qsort(ranked, count, sizeof(ranked_problem_t), by_decreasing_cost);
+
+    for (p = 0; p < count; p++) {
+        best = 0;
+        best_finish = (load[0] + ranked[p].cost) / group_ranks[0];
+        for (g = 1; g < groups; g++) {
+            finish = (load[g] + ranked[p].cost) / group_ranks[g];
+            if (finish < best_finish) {
+                best = g;
+                best_finish = finish;
+            }
+        }
+        load[best] += ranked[p].cost;
+        owner[ranked[p].index] = best;
+    }
+
+    for (g = 0; g < groups; g++) {
+        if (load[g] / group_ranks[g] > makespan) makespan = load[g] / group_ranks[g];
+    }
+
+    free(ranked);
+    free(load);
+    return makespan;
+}
@@ -0,0 +1,31 @@
+/*
+ * Problem lists and static scheduling for batch runs
+ *
+ * A batch is a text file with one problem per line, "n m iter_max", where blank lines and
+ * lines starting with '#' are skipped. Problems are assigned whole to groups of ranks by
+ * longest-processing-time-first: in order of decreasing cost, every problem goes to the group
+ * that would finish it first, counting the cost as spread evenly over the ranks of the group.
+ * The cost of a problem is its interior points times iter_max, an upper bound when problems
+ * converge early.
+ */
+#ifndef PPM_BATCH_H
+#define PPM_BATCH_H
+
+typedef struct {
+    int n, m;      // Grid size
+    int iter_max;  // Iteration limit
+} ppm_problem_t;
+
+/* Read the problems of 'path' into a malloc'ed array stored in 'problems'. Returns the number
+ * of problems, or -1 after printing the reason to stderr */
+int ppm_batch_read(const char *path, ppm_problem_t **problems);
+
+/* Estimated cost of a problem: interior points times iter_max */
+double ppm_problem_cost(const ppm_problem_t *problem);
+
+/* Assign 'count' problems to 'groups' groups of group_ranks[g] ranks each, storing the group of
+ * problem p in owner[p]. Returns the estimated makespan (largest cost per rank of a group) */
+double ppm_batch_schedule(const ppm_problem_t *problems, int count, const int *group_ranks,
+                          int groups, int *owner);
+
+#endif  // PPM_BATCH_H
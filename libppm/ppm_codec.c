@@ -0,0 +1,235 @@
+#include "ppm_codec.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ppm_instr.h"
+
+static const char *codec_names[PPM_NUM_CODECS] = {"none", "bf16", "fp16", "delta"};
+
+/* Scratch buffers of ppm_codec_sendrecv(), grown on demand */
+static unsigned char *send_buffer, *recv_buffer;
+static int buffer_size;
+
+const char *ppm_codec_name(ppm_codec_t codec) { return codec_names[codec]; }
+
+ppm_codec_t ppm_halo_codec(void) {
+    static int codec = -1;
+    const char *name;
+    int c;
+
+    if (codec >= 0) return (ppm_codec_t)codec;
+
+    codec = PPM_CODEC_NONE;
+    name = getenv("PPM_HALO_CODEC");
+    if (name == NULL || name[0] == '\0') return (ppm_codec_t)codec;
+
+    for (c = 0; c < PPM_NUM_CODECS; c++) {
+        if (strcmp(name, codec_names[c]) == 0) codec = c;
+    }
+    if (codec == PPM_CODEC_NONE && strcmp(name, "none") != 0) {
+        fprintf(stderr, "-- Warning: unknown PPM_HALO_CODEC '%s', sending uncompressed rows\n",
+                name);
+    }
+    return (ppm_codec_t)codec;
+}
+
+int ppm_codec_max_bytes(ppm_codec_t codec, int count) {
+    switch (codec) {
+        case PPM_CODEC_BF16:
+        case PPM_CODEC_FP16:
+            return 2 * count;
+        case PPM_CODEC_DELTA:
+            return (count + 1) / 2 + count * (int)sizeof(real_t);
+        default:
+            return count * (int)sizeof(real_t);
+    }
+}
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Round to nearest even on the 16 dropped bits; NaNs stay NaNs */
+static uint16_t float_to_bf16(float value) {
+    uint32_t bits = float_bits(value);
+
+    if ((bits & 0x7fffffff) > 0x7f800000) return (uint16_t)((bits >> 16) | 0x40);
+    return (uint16_t)((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);
+}
+
+static float bf16_to_float(uint16_t half) { return bits_float((uint32_t)half << 16); }
+
+/* IEEE binary16 with round to nearest even, subnormals, overflow to infinity */
+static uint16_t float_to_fp16(float value) {
+    uint32_t bits = float_bits(value);
+    uint32_t sign = (bits >> 16) & 0x8000, mantissa = bits & 0x7fffff, half, rest, middle;
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15, shift;
+
+    if (((bits >> 23) & 0xff) == 0xff) return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31) return (uint16_t)(sign | 0x7c00);
+    if (exponent <= 0) {
+        if (exponent < -10) return (uint16_t)sign;
+        mantissa |= 0x800000;
+        shift = 14 - exponent;
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        middle = 1u << (shift - 1);
+    } else {
+        half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1fff;
+        middle = 0x1000;
+    }
+    // A carry out of the mantissa correctly bumps the exponent (up to infinity)
+    if (rest > middle || (rest == middle && (half & 1))) half++;
+    return (uint16_t)(sign | half);
+}
+
+static float fp16_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+
+    if (exponent == 0x1f) return bits_float(sign | 0x7f800000 | (mantissa << 13));
+    if (exponent != 0) return bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    if (mantissa == 0) return bits_float(sign);
+
+    // Subnormal: shift the leading one into the implicit bit
+    exponent = 113;
+    while (!(mantissa & 0x400)) {
+        mantissa <<= 1;
+        exponent--;
+    }
+    return bits_float(sign | (exponent << 23) | ((mantissa & 0x3ff) << 13));
+}
+
+/* Delta layout: (count + 1) / 2 bytes of 4-bit lengths (element 2k in the low nibble of byte
+ * k), then the significant bytes of every XOR delta, least significant first */
+static int delta_pack(const real_t *row, int count, unsigned char *buffer) {
+    unsigned char *lengths = buffer, *payload = buffer + (count + 1) / 2;
+    uint64_t previous = 0, bits, delta;
+    int i, length;
+
+    memset(lengths, 0, (count + 1) / 2);
+    for (i = 0; i < count; i++) {
+        bits = 0;
+        memcpy(&bits, &row[i], sizeof(real_t));
+        delta = bits ^ previous;
+        previous = bits;
+
+        for (length = 0; length < (int)sizeof(real_t) && delta >> (8 * length); length++) {
+            *payload++ = (unsigned char)(delta >> (8 * length));
+        }
+        lengths[i / 2] |= (unsigned char)(length << (4 * (i % 2)));
+    }
+    return (int)(payload - buffer);
+}
+
+static void delta_unpack(const unsigned char *buffer, real_t *row, int count) {
+    const unsigned char *lengths = buffer, *payload = buffer + (count + 1) / 2;
+    uint64_t previous = 0, delta;
+    int i, b, length;
+
+    for (i = 0; i < count; i++) {
+        length = (lengths[i / 2] >> (4 * (i % 2))) & 0xf;
+        delta = 0;
+        for (b = 0; b < length; b++) delta |= (uint64_t)*payload++ << (8 * b);
+        previous ^= delta;
+        memcpy(&row[i], &previous, sizeof(real_t));
+    }
+}
+
+int ppm_codec_pack(ppm_codec_t codec, const real_t *row, int count, unsigned char *buffer) {
+    uint16_t half;
+    int i;
+
+    switch (codec) {
+        case PPM_CODEC_BF16:
+        case PPM_CODEC_FP16:
+            for (i = 0; i < count; i++) {
+                half = codec == PPM_CODEC_BF16 ? float_to_bf16((float)row[i])
+                                               : float_to_fp16((float)row[i]);
+                memcpy(&buffer[2 * i], &half, sizeof(half));
+            }
+            return 2 * count;
+        case PPM_CODEC_DELTA:
+            return delta_pack(row, count, buffer);
+        default:
+            memcpy(buffer, row, sizeof(real_t) * count);
+            return (int)sizeof(real_t) * count;
+    }
+}
+
+void ppm_codec_unpack(ppm_codec_t codec, const unsigned char *buffer, int bytes, real_t *row,
+                      int count) {
+    uint16_t half;
+    int i;
+
+    switch (codec) {
+        case PPM_CODEC_BF16:
+        case PPM_CODEC_FP16:
+            for (i = 0; i < count && 2 * i + 1 < bytes; i++) {
+                memcpy(&half, &buffer[2 * i], sizeof(half));
+                row[i] = codec == PPM_CODEC_BF16 ? bf16_to_float(half) : fp16_to_float(half);
+            }
+            break;
+        case PPM_CODEC_DELTA:
+            delta_unpack(buffer, row, count);
+            break;
+        default:
+            memcpy(row, buffer, bytes);
+            break;
+    }
+}
+
+void ppm_codec_sendrecv(const real_t *send, real_t *recv, int count, int peer, int send_tag,
+                        int recv_tag, MPI_Comm comm) {
+    const ppm_codec_t codec = ppm_halo_codec();
+    MPI_Status status;
+    int max_bytes, send_bytes, recv_bytes;
+
+    if (codec == PPM_CODEC_NONE) {
+        ppm_count_message(count, MPI_REAL_T);
+        MPI_Sendrecv(send, count, MPI_REAL_T, peer, send_tag, recv, count, MPI_REAL_T, peer,
+                     recv_tag, comm, MPI_STATUS_IGNORE);
+        return;
+    }
+
+    max_bytes = ppm_codec_max_bytes(codec, count);
+    if (max_bytes > buffer_size) {
+        free(send_buffer);
+        free(recv_buffer);
+        send_buffer = malloc(max_bytes);
+        recv_buffer = malloc(max_bytes);
+        if (send_buffer == NULL || recv_buffer == NULL) {
+            fprintf(stderr, "-- Error allocating: halo codec buffers\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+        buffer_size = max_bytes;
+    }
+
+    ppm_phase_begin(PPM_PHASE_PACK);
+    send_bytes = ppm_codec_pack(codec, send, count, send_buffer);
+    ppm_phase_end(PPM_PHASE_PACK);
+
+    // Delta messages vary in length: receive up to the bound and read the actual size
+    ppm_count_message(send_bytes, MPI_BYTE);
+    MPI_Sendrecv(send_buffer, send_bytes, MPI_BYTE, peer, send_tag, recv_buffer, max_bytes,
+                 MPI_BYTE, peer, recv_tag, comm, &status);
+    MPI_Get_count(&status, MPI_BYTE, &recv_bytes);
+
+    ppm_phase_begin(PPM_PHASE_PACK);
+    ppm_codec_unpack(codec, recv_buffer, recv_bytes, recv, count);
+    ppm_phase_end(PPM_PHASE_PACK);
+}
@@ -0,0 +1,52 @@
+/*
+ * Optional compression of halo rows
+ *
+ * Selected at run time with the PPM_HALO_CODEC environment variable:
+ *
+ *   none   (default) rows are sent as they are, count elements of MPI_REAL_T
+ *   bf16   lossy, 2 bytes per element: the upper half of the float (8-bit mantissa)
+ *   fp16   lossy, 2 bytes per element: IEEE half precision (11-bit mantissa, |x| < 65504)
+ *   delta  lossless: every element is XORed with the previous one and only its significant
+ *          bytes are sent, plus a 4-bit length per element. Smooth or zero rows shrink most
+ *
+ * Packing and unpacking are timed in the "pack" phase of ppm_instr.h, which is nested inside
+ * "halo", and the bytes counted per message are the compressed ones, so a run report shows
+ * both the bytes saved and what the codec cost.
+ */
+#ifndef PPM_CODEC_H
+#define PPM_CODEC_H
+
+#include <mpi.h>
+
+#include "ppm_real.h"
+
+typedef enum {
+    PPM_CODEC_NONE,
+    PPM_CODEC_BF16,
+    PPM_CODEC_FP16,
+    PPM_CODEC_DELTA,
+    PPM_NUM_CODECS
+} ppm_codec_t;
+
+const char *ppm_codec_name(ppm_codec_t codec);
+
+/* Codec named by $PPM_HALO_CODEC, read once. Unknown names warn and fall back to none */
+ppm_codec_t ppm_halo_codec(void);
+
+/* Upper bound of the packed size of 'count' elements, in bytes */
+int ppm_codec_max_bytes(ppm_codec_t codec, int count);
+
+/* Pack 'count' elements of 'row' into 'buffer' and return the packed size in bytes */
+int ppm_codec_pack(ppm_codec_t codec, const real_t *row, int count, unsigned char *buffer);
+
+/* Unpack 'count' elements from the first 'bytes' bytes of 'buffer' into 'row' */
+void ppm_codec_unpack(ppm_codec_t codec, const unsigned char *buffer, int bytes, real_t *row,
+                      int count);
+
+/* MPI_Sendrecv of one halo row with 'peer' through the codec of $PPM_HALO_CODEC: sends
+ * 'count' elements of 'send' and receives 'count' elements into 'recv'. Counts the message in
+ * the instrumentation. Both sides must use the same codec */
+void ppm_codec_sendrecv(const real_t *send, real_t *recv, int count, int peer, int send_tag,
+                        int recv_tag, MPI_Comm comm);
+
+#endif  // PPM_CODEC_H
@@ -0,0 +1,424 @@
+#include "ppm_fire.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ppm_instr.h"
+#include "ppm_report.h"
+
+#define RADIUS_TYPE_1 3
+#define RADIUS_TYPE_2_3 9
+#define THRESHOLD PPM_FIRE_THRESHOLD
+
+/* Local surfaces: rows of 'pitch' elements, row 0 and chunk + 1 are halos */
+#define accessLocal(arr, exp1, exp2) arr[(exp1) * pitch + (exp2)]
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/* Rank of 'size' that owns global row 'row', the inverse of ppm_slab_partition() */
+static int row_owner(int rows, int size, int row) {
+    int base = rows / size, extra = rows % size;
+
+    if (row < extra * (base + 1)) return row / (base + 1);
+    return extra + (row - extra * (base + 1)) / base;
+}
+
+const ppm_halo_ops_t *ppm_fire_halo(void) {
+    const char *name = getenv("PPM_HALO");
+    const ppm_halo_ops_t *halo;
+
+    if (name == NULL || name[0] == '\0') name = "blocking";
+    halo = ppm_halo_find(name);
+    if (halo == NULL || halo->in_place) {
+        fprintf(stderr, "-- Error in PPM_HALO: '%s' is not blocking, nonblocking or rma\n", name);
+        return NULL;
+    }
+    return halo;
+}
+
+int ppm_fire_read(const char *path, ppm_fire_scenario_t *scenario) {
+    FILE *args = fopen(path, "rb");
+    char magic[sizeof(PPM_FIRE_MAGIC) - 1];
+    int i, ok;
+
+    scenario->teams = NULL;
+    scenario->focal = NULL;
+    if (args == NULL) {
+        fprintf(stderr, "-- Error in file: not found: %s\n", path);
+        return -1;
+    }
+
+    /* Binary scenarios start with their magic, text ones with a number */
+    if (fread(magic, 1, sizeof(magic), args) == sizeof(magic) &&
+        memcmp(magic, PPM_FIRE_MAGIC, sizeof(magic)) == 0) {
+        if (ppm_fire_read_binary(args, path, scenario) != 0) goto error;
+        fclose(args);
+        return 0;
+    }
+    rewind(args);
+
+    /* Surface and maximum number of iterations */
+    ok = fscanf(args, "%d %d %d", &scenario->rows, &scenario->columns, &scenario->max_iter);
+    if (ok != 3) {
+        fprintf(stderr, "-- Error in file: reading rows, columns, max_iter from file: %s\n", path);
+        goto error;
+    }
+
+    /* Teams information */
+    if (fscanf(args, "%d", &scenario->num_teams) != 1 || scenario->num_teams < 0) {
+        fprintf(stderr, "-- Error file, reading num_teams from file: %s\n", path);
+        goto error;
+    }
+    scenario->teams = (ppm_team_t *)malloc(sizeof(ppm_team_t) * ((size_t)scenario->num_teams + 1));
+    if (scenario->teams == NULL) {
+        fprintf(stderr, "-- Error allocating: %d teams\n", scenario->num_teams);
+        goto error;
+    }
+    for (i = 0; i < scenario->num_teams; i++) {
+        ppm_team_t *team = &scenario->teams[i];
+        if (fscanf(args, "%d %d %d", &team->x, &team->y, &team->type) != 3) {
+            fprintf(stderr, "-- Error in file: reading team %d from file: %s\n", i, path);
+            goto error;
+        }
+    }
+
+    /* Focal points information */
+    if (fscanf(args, "%d", &scenario->num_focal) != 1 || scenario->num_focal < 0) {
+        fprintf(stderr, "-- Error in file: reading num_focal from file: %s\n", path);
+        goto error;
+    }
+    scenario->focal =
+        (ppm_focal_t *)malloc(sizeof(ppm_focal_t) * ((size_t)scenario->num_focal + 1));
+    if (scenario->focal == NULL) {
+        fprintf(stderr, "-- Error allocating: %d focal points\n", scenario->num_focal);
+        goto error;
+    }
+    for (i = 0; i < scenario->num_focal; i++) {
+        ppm_focal_t *point = &scenario->focal[i];
+        if (fscanf(args, "%d %d %d %d", &point->x, &point->y, &point->start, &point->heat) != 4) {
+            fprintf(stderr, "-- Error in file: reading focal point %d from file: %s\n", i, path);
+            goto error;
+        }
+        point->active = 0;
+    }
+
+    fclose(args);
+    return 0;
+
+error:
+    fclose(args);
+    ppm_fire_free(scenario);
+    return -1;
+}
+
+void ppm_fire_free(ppm_fire_scenario_t *scenario) {
+    free(scenario->teams);
+    free(scenario->focal);
+    scenario->teams = NULL;
+    scenario->focal = NULL;
+}
+
+int ppm_fire_run(ppm_slab_t *slab, ppm_fire_scenario_t *scenario, ppm_fire_result_t *result) {
+    const int rows = scenario->rows, columns = scenario->columns, max_iter = scenario->max_iter;
+    const int num_teams = scenario->num_teams, num_focal = scenario->num_focal;
+    ppm_team_t *teams = scenario->teams;
+    ppm_focal_t *focal = scenario->focal;
+    real_t *surface, *surfaceCopy;
+    size_t pitch;
+    int i, j, t;
+
+    /* 3. Initialize surfaces (local with halos). The rows are split over the processes (the
+     * first rows % size take one more) and both surfaces are allocated zeroed */
+    if (ppm_slab_setup(slab, rows, columns) != 0) return -1;
+    pitch = slab->pitch;
+    surface = slab->grid[0];
+    surfaceCopy = slab->grid[1];
+
+    int global_rows = rows;
+    int chunk = slab->local_rows; /* number of real rows owned by this process */
+    int local_nrows = chunk + 2;  /* include two halo rows */
+
+    /* Local starting global index for this rank */
+    int g_start = slab->first_row;
+    int g_end = g_start + chunk - 1;
+
+    /* Bounding box of the cells that may be hot, the same on all processes: focal points heat
+     * their cell, every heat step spreads heat by one cell and teams only cool. Outside of it
+     * the surface and its copy are a steady cold region of zeros, which the heat steps skip
+     * without changing any value */
+    int hot_first = global_rows, hot_last = -1, hot_left = columns, hot_right = -1;
+    double heat_points = 0.0;
+
+    /* 4. Simulation */
+    int iter;
+    int flag_stability = 0;
+    float last_residual = 0.0f;
+    for (iter = 0; iter < max_iter && !flag_stability; iter++) {
+        /* 4.1. Activate focal points. Focal points are updated redundantly, so every process
+         * counts all of them and no reduction is needed */
+        int num_deactivated = 0;
+        int num_active = 0;
+        for (i = 0; i < num_focal; i++) {
+            if (focal[i].start == iter) {
+                focal[i].active = 1;
+            }
+            /* Count focal points already deactivated by a team */
+            if (focal[i].active == 2) num_deactivated++;
+            if (focal[i].active == 1) num_active++;
+        }
+
+        /* 4.1.5. Fast-forward: on a cold surface without active focal points the heat steps keep
+         * it at zero and teams have no target, so nothing changes until the next focal point
+         * starts */
+        if (hot_last < 0 && num_active == 0) {
+            last_residual = 0.0f;
+            for (t = 0; t < num_teams; t++) teams[t].target = -1;
+            if (num_deactivated == num_focal) {
+                flag_stability = 1;
+                continue;
+            }
+            int next_start = max_iter;
+            for (i = 0; i < num_focal; i++)
+                if (focal[i].active == 0 && focal[i].start > iter && focal[i].start < next_start)
+                    next_start = focal[i].start;
+            iter = next_start - 1;
+            continue;
+        }
+
+        /* 4.2. Propagate heat (10 steps per each team movement) */
+        float global_residual = 0.0f;
+        int step;
+
+        for (step = 0; step < 10; step++) {
+            /* 4.2.1. Update heat on active focal points (only if this process owns the row) */
+            ppm_phase_begin(PPM_PHASE_FOCAL);
+            for (i = 0; i < num_focal; i++) {
+                if (focal[i].active != 1) continue;
+                int gx = focal[i].x;
+                int gy = focal[i].y;
+                /* Check bounds */
+                if (gx < 0 || gx > global_rows - 1 || gy < 0 || gy > columns - 1) continue;
+                hot_first = MIN(hot_first, gx);
+                hot_last = MAX(hot_last, gx);
+                hot_left = MIN(hot_left, gy);
+                hot_right = MAX(hot_right, gy);
+                /* If the focal point belongs to this process */
+                if (gx >= g_start && gx <= g_end) {
+                    int local_i = (gx - g_start) + 1; /* local index 1..chunk */
+                    accessLocal(surface, local_i, gy) = focal[i].heat;
+                }
+            }
+            ppm_phase_end(PPM_PHASE_FOCAL);
+
+            /* Nothing hot yet: the step keeps the surface at zero */
+            if (hot_last < 0) {
+                global_residual = 0.0f;
+                continue;
+            }
+
+            /* Global rows and columns the stencil can change (the box grown by one cell, without
+             * the global borders), and its local rows 'row_begin' to 'row_end' */
+            int gx_begin = MAX(hot_first - 1, 1), gx_end = MIN(hot_last + 1, global_rows - 2);
+            int col_begin = MAX(hot_left - 1, 1), col_end = MIN(hot_right + 1, columns - 2);
+            int row_begin = MAX(gx_begin - g_start + 1, 1);
+            int row_end = MIN(gx_end - g_start + 1, chunk);
+            if (gx_begin <= gx_end && col_begin <= col_end)
+                heat_points += (double)(gx_end - gx_begin + 1) * (col_end - col_begin + 1);
+
+            /* 4.2.1.5 Exchange halo rows with neighbors so halos are up-to-date in 'surface':
+             * local row 1 goes to rank-1 and row chunk to rank+1 (the halos of the first and
+             * last rank keep their zeros). Compressed if PPM_HALO_CODEC is set. Skipped by all
+             * processes while no slab boundary is next to the box, as every halo is still zero */
+            if (row_owner(global_rows, slab->size, MAX(hot_first - 1, 0)) !=
+                row_owner(global_rows, slab->size, MIN(hot_last + 1, global_rows - 1)))
+                ppm_slab_exchange(slab, surface);
+
+            /* The three sweeps share the threads of one parallel region (hybrid build), split
+             * by rows; the implicit barrier of each loop orders them */
+            float local_residual = 0.0f;
+            ppm_phase_begin(PPM_PHASE_SWEEP);
+#pragma omp parallel private(j)
+            {
+                /* 4.2.2. Copy values of the surface in ancillary structure (including halos),
+                 * the rows and columns the stencil reads */
+#pragma omp for
+                for (i = MAX(row_begin - 1, 0); i <= MIN(row_end + 1, local_nrows - 1); i++)
+                    for (j = col_begin - 1; j <= col_end + 1; j++)
+                        accessLocal(surfaceCopy, i, j) = accessLocal(surface, i, j);
+
+                /* 4.2.3. Update surface values (skip global borders) */
+                /* We update only local real rows (1..chunk) whose global index is in [1 ..
+                 * global_rows-2], inside the box */
+#pragma omp for
+                for (i = row_begin; i <= row_end; i++) {
+                    for (j = col_begin; j <= col_end; j++) {
+                        accessLocal(surface, i, j) = (accessLocal(surfaceCopy, i - 1, j) +
+                                                      accessLocal(surfaceCopy, i + 1, j) +
+                                                      accessLocal(surfaceCopy, i, j - 1) +
+                                                      accessLocal(surfaceCopy, i, j + 1)) /
+                                                     4.0f;
+                    }
+                }
+
+                /* 4.2.4. Compute the maximum residual difference (absolute value) locally */
+#pragma omp for reduction(max : local_residual)
+                for (i = row_begin; i <= row_end; i++) {
+                    for (j = col_begin; j <= col_end; j++) {
+                        float diff =
+                            fabs(accessLocal(surface, i, j) - accessLocal(surfaceCopy, i, j));
+                        if (diff > local_residual) local_residual = diff;
+                    }
+                }
+            }
+            ppm_phase_end(PPM_PHASE_SWEEP);
+
+            /* Reduce to get the global maximum residual across all processes */
+            global_residual = local_residual;
+            ppm_slab_allreduce(slab, &global_residual, 1, MPI_FLOAT, MPI_MAX);
+
+            /* The step spread heat by one cell */
+            hot_first = MAX(hot_first - 1, 0);
+            hot_last = MIN(hot_last + 1, global_rows - 1);
+            hot_left = MAX(hot_left - 1, 0);
+            hot_right = MIN(hot_right + 1, columns - 1);
+        }
+
+        /* If the global residual is lower than THRESHOLD, we have reached enough stability, stop
+         * simulation at the end of this iteration */
+        if (num_deactivated == num_focal && global_residual < THRESHOLD) flag_stability = 1;
+        last_residual = global_residual;
+
+        /* 4.3. Move teams (redundant on all processes). Every team only reads the focal points
+         * and writes itself, so threads take teams independently */
+        ppm_phase_begin(PPM_PHASE_TEAM);
+
+#pragma omp parallel for private(j)
+        for (t = 0; t < num_teams; t++) {
+            /* 4.3.1. Choose nearest focal point */
+            float distance = FLT_MAX;
+            int target = -1;
+            for (j = 0; j < num_focal; j++) {
+                if (focal[j].active != 1) continue;  // Skip non-active focal points
+                float dx = focal[j].x - teams[t].x;
+                float dy = focal[j].y - teams[t].y;
+                float local_distance = sqrtf(dx * dx + dy * dy);
+                if (local_distance < distance) {
+                    distance = local_distance;
+                    target = j;
+                }
+            }
+            /* 4.3.2. Annotate target for the next stage */
+            teams[t].target = target;
+
+            /* 4.3.3. No active focal point to choose, no movement */
+            if (target == -1) continue;
+
+            /* 4.3.4. Move in the focal point direction */
+            if (teams[t].type == 1) {
+                // Type 1: Can move in diagonal
+                if (focal[target].x < teams[t].x) teams[t].x--;
+                if (focal[target].x > teams[t].x) teams[t].x++;
+                if (focal[target].y < teams[t].y) teams[t].y--;
+                if (focal[target].y > teams[t].y) teams[t].y++;
+            } else if (teams[t].type == 2) {
+                // Type 2: First in horizontal direction, then in vertical direction
+                if (focal[target].y < teams[t].y)
+                    teams[t].y--;
+                else if (focal[target].y > teams[t].y)
+                    teams[t].y++;
+                else if (focal[target].x < teams[t].x)
+                    teams[t].x--;
+                else if (focal[target].x > teams[t].x)
+                    teams[t].x++;
+            } else {
+                // Type 3: First in vertical direction, then in horizontal direction
+                if (focal[target].x < teams[t].x)
+                    teams[t].x--;
+                else if (focal[target].x > teams[t].x)
+                    teams[t].x++;
+                else if (focal[target].y < teams[t].y)
+                    teams[t].y--;
+                else if (focal[target].y > teams[t].y)
+                    teams[t].y++;
+            }
+        }
+
+        /* 4.4. Team actions */
+
+        /* 4.4.1. Deactivate the target focal point when it is reached */
+        for (t = 0; t < num_teams; t++) {
+            int target = teams[t].target;
+            if (target != -1 && focal[target].x == teams[t].x && focal[target].y == teams[t].y &&
+                focal[target].active == 1)
+                focal[target].active = 2;
+        }
+
+        /* 4.4.2. Reduce heat in a circle around every team, only on the rows this rank owns.
+         * Circles overlap, so each thread cools a band of the owned rows for all teams in
+         * order: no two threads write the same cell, and every cell is scaled as many times as
+         * in the sequential code */
+        int owned_first = MAX(g_start, 1), owned_last = MIN(g_end, rows - 2);
+#pragma omp parallel private(i, j, t)
+        {
+#ifdef _OPENMP
+            int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+#else
+            int threads = 1, thread = 0;
+#endif
+            int owned = MAX(owned_last - owned_first + 1, 0);
+            int band_first = owned_first + (int)((long)owned * thread / threads);
+            int band_last = owned_first + (int)((long)owned * (thread + 1) / threads) - 1;
+
+            for (t = 0; t < num_teams; t++) {
+                int radius;
+                // Influence area of fixed radius depending on type
+                if (teams[t].type == 1)
+                    radius = RADIUS_TYPE_1;
+                else
+                    radius = RADIUS_TYPE_2_3;
+                for (i = MAX(teams[t].x - radius, band_first);
+                     i <= MIN(teams[t].x + radius, band_last); i++) {
+                    int local_i = (i - g_start) + 1;
+                    for (j = teams[t].y - radius; j <= teams[t].y + radius; j++) {
+                        if (j < 1 || j >= columns - 1) continue;  // Out of the heated surface
+                        float dx = teams[t].x - i;
+                        float dy = teams[t].y - j;
+                        float distance = sqrtf(dx * dx + dy * dy);
+                        if (distance <= radius) {
+                            accessLocal(surface, local_i, j) =
+                                accessLocal(surface, local_i, j) *
+                                (1 - 0.25);  // Team efficiency factor
+                        }
+                    }
+                }
+            }
+        }
+        ppm_phase_end(PPM_PHASE_TEAM);
+    }
+
+
+    result->iterations = iter;
+    result->residual = last_residual;
+    result->heat_points = heat_points;
+    return 0;
+}
+
+void ppm_fire_report(ppm_slab_t *slab, const ppm_fire_result_t *result) {
+    /* Per heat step every interior point costs 6 flops (4 stencil + 2 residual) and streams 6
+     * elements (copy: 1 load + 1 store, stencil: 1 load + 1 store, residual: 2 loads) */
+    ppm_run_info_t info = {"fire",
+                           slab->rows,
+                           slab->columns,
+                           result->iterations,
+                           result->residual,
+                           6.0 * result->heat_points,
+                           6.0 * sizeof(real_t) * result->heat_points};
+    ppm_report(slab->comm, &info);
+}
@@ -0,0 +1,60 @@
+/*
+ * Distributed fire extinguishing simulation
+ *
+ * The surface is split in row slabs (ppm_slab.h). Every iteration activates the focal points
+ * that start, propagates heat in 10 Jacobi steps (each one preceded by a halo exchange and
+ * followed by a global residual), then moves the teams towards their nearest active focal
+ * point and lets them cool the surface around them. Teams and focal points are small and are
+ * updated redundantly on every rank. The simulation stops after max_iter iterations, or once
+ * all focal points are deactivated and the residual is below PPM_FIRE_THRESHOLD.
+ *
+ * Heat steps only sweep the bounding box of the cells that can be hot, and skip the halo
+ * exchange while no slab boundary is next to it; iterations before the first focal point
+ * starts are skipped altogether. The cold cells they leave out stay at zero, so the results
+ * are the same as sweeping the whole surface.
+ *
+ * Scenario files use the format of the simulator's "-f" option:
+ *
+ *     rows columns max_iter
+ *     num_teams   followed by "x y type" per team
+ *     num_focal   followed by "x y start heat" per focal point
+ *
+ * or its binary form ("-b" option, fire-simulator/tools/generate_scenario.py), see
+ * ppm_fire_file.h.
+ */
+#ifndef PPM_FIRE_H
+#define PPM_FIRE_H
+
+#include "ppm_fire_file.h"
+#include "ppm_real.h"
+#include "ppm_slab.h"
+
+#define PPM_FIRE_THRESHOLD 0.1f
+
+typedef struct {
+    int iterations;        // Iterations executed
+    float residual;        // Global residual of the last iteration
+    double heat_points;    // Interior points updated, over all heat steps
+} ppm_fire_result_t;
+
+/* Halo exchange strategy named by the PPM_HALO environment variable, "blocking" when unset.
+ * The simulation copies the surface after the exchange, so strategies that read the neighbour
+ * rows in place are rejected: returns NULL after printing the reason to stderr */
+const ppm_halo_ops_t *ppm_fire_halo(void);
+
+/* Read a scenario file, text or binary. Returns 0, or -1 after printing the reason to stderr */
+int ppm_fire_read(const char *path, ppm_fire_scenario_t *scenario);
+
+/* Free the teams and focal points of a scenario */
+void ppm_fire_free(ppm_fire_scenario_t *scenario);
+
+/* Run the scenario on the ranks of 'slab' (ppm_slab_init() with a strategy that fills the
+ * halos), updating its teams and focal points. The final surface is left in slab->grid[0]
+ * until the next run; ppm_slab_gather() collects it. Returns -1 if the surface cannot be split
+ * or allocated. Collective */
+int ppm_fire_run(ppm_slab_t *slab, ppm_fire_scenario_t *scenario, ppm_fire_result_t *result);
+
+/* ppm_report() the last run of 'slab'. Collective */
+void ppm_fire_report(ppm_slab_t *slab, const ppm_fire_result_t *result);
+
+#endif  // PPM_FIRE_H
@@ -0,0 +1,115 @@
+/*
+ * Fire scenarios and their binary file format, shared by ppm_fire.c and the standalone
+ * sequential and OpenMP simulators, which do not link libppm (no MPI). Header-only for that
+ * reason.
+ *
+ * A binary scenario (fire-simulator/tools/generate_scenario.py) is PPM_FIRE_MAGIC followed by
+ * the values of the simulator's "-f" text format, in the same order, as little-endian 32-bit
+ * integers:
+ *
+ *     rows columns max_iter num_teams, "x y type" per team,
+ *     num_focal, "x y start heat" per focal point
+ *
+ * The integers are decoded byte by byte, so big-endian hosts read the same scenarios.
+ */
+#ifndef PPM_FIRE_FILE_H
+#define PPM_FIRE_FILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* First bytes of binary scenario files */
+#define PPM_FIRE_MAGIC "PPMFIRE1"
+
+/* Extinguishing team, the simulators' Team */
+typedef struct {
+    int x, y;
+    int type;
+    int target;
+} ppm_team_t;
+
+/* Fire focal point, the simulators' FocalPoint */
+typedef struct {
+    int x, y;
+    int start;
+    int heat;
+    int active;  // States: 0 Not yet activated; 1 Active; 2 Deactivated by a team
+} ppm_focal_t;
+
+typedef struct {
+    int rows, columns, max_iter;
+    int num_teams, num_focal;
+    ppm_team_t *teams;
+    ppm_focal_t *focal;
+} ppm_fire_scenario_t;
+
+/* Read 'count' little-endian 32-bit integers. Returns 0, or -1 at the end of the file */
+static inline int ppm_fire_read_ints(FILE *file, int *values, int count) {
+    unsigned char bytes[4];
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return -1;
+        values[i] = (int32_t)((uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+                              (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24);
+    }
+    return 0;
+}
+
+/* Read the rest of a binary scenario file, after its magic. Returns 0, or -1 after printing the
+ * reason to stderr; the teams and focal points read so far are left for the caller to free */
+static inline int ppm_fire_read_binary(FILE *args, const char *path,
+                                       ppm_fire_scenario_t *scenario) {
+    int header[4], values[4], i;
+
+    scenario->teams = NULL;
+    scenario->focal = NULL;
+    if (ppm_fire_read_ints(args, header, 4) != 0 || header[3] < 0) {
+        fprintf(stderr, "-- Error in file: reading the binary header from file: %s\n", path);
+        return -1;
+    }
+    scenario->rows = header[0];
+    scenario->columns = header[1];
+    scenario->max_iter = header[2];
+    scenario->num_teams = header[3];
+    scenario->teams = (ppm_team_t *)malloc(sizeof(ppm_team_t) * ((size_t)scenario->num_teams + 1));
+    if (scenario->teams == NULL) {
+        fprintf(stderr, "-- Error allocating: %d teams\n", scenario->num_teams);
+        return -1;
+    }
+    for (i = 0; i < scenario->num_teams; i++) {
+        if (ppm_fire_read_ints(args, values, 3) != 0) {
+            fprintf(stderr, "-- Error in file: reading team %d from file: %s\n", i, path);
+            return -1;
+        }
+        scenario->teams[i].x = values[0];
+        scenario->teams[i].y = values[1];
+        scenario->teams[i].type = values[2];
+    }
+
+    if (ppm_fire_read_ints(args, &scenario->num_focal, 1) != 0 || scenario->num_focal < 0) {
+        fprintf(stderr, "-- Error in file: reading num_focal from file: %s\n", path);
+        return -1;
+    }
+    scenario->focal =
+        (ppm_focal_t *)malloc(sizeof(ppm_focal_t) * ((size_t)scenario->num_focal + 1));
+    if (scenario->focal == NULL) {
+        fprintf(stderr, "-- Error allocating: %d focal points\n", scenario->num_focal);
+        return -1;
+    }
+    for (i = 0; i < scenario->num_focal; i++) {
+        if (ppm_fire_read_ints(args, values, 4) != 0) {
+            fprintf(stderr, "-- Error in file: reading focal point %d from file: %s\n", i, path);
+            return -1;
+        }
+        scenario->focal[i].x = values[0];
+        scenario->focal[i].y = values[1];
+        scenario->focal[i].start = values[2];
+        scenario->focal[i].heat = values[3];
+        scenario->focal[i].active = 0;
+    }
+    return 0;
+}
+
+#endif  // PPM_FIRE_FILE_H
@@ -0,0 +1,106 @@
+#include "ppm_grid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0
+#endif
+
+static const char *pages_names[] = {"regular", "thp", "hugetlb"};
+
+const char *ppm_pages_name(ppm_pages_t pages) { return pages_names[pages]; }
+
+size_t ppm_pitch(size_t columns, size_t element_size) {
+    size_t bytes = (columns * element_size + PPM_ALIGN - 1) / PPM_ALIGN * PPM_ALIGN;
+
+    // Rows 4 KiB apart map to the same L1 sets: one more cache line breaks the aliasing
+    if (bytes % 4096 == 0) bytes += PPM_ALIGN;
+    return bytes / element_size;
+}
+
+size_t ppm_grid_bytes(size_t rows, size_t pitch, size_t element_size) {
+    return (rows * pitch * element_size + PPM_ALIGN - 1) / PPM_ALIGN * PPM_ALIGN;
+}
+
+static ppm_pages_t requested_pages(void) {
+    const char *pages = getenv("PPM_HUGEPAGES");
+
+    if (pages == NULL || pages[0] == '\0' || strcmp(pages, "thp") == 0) return PPM_PAGES_THP;
+    if (strcmp(pages, "hugetlb") == 0) return PPM_PAGES_HUGETLB;
+    if (strcmp(pages, "off") != 0) {
+        fprintf(stderr, "-- Warning: unknown PPM_HUGEPAGES '%s', using regular pages\n", pages);
+    }
+    return PPM_PAGES_REGULAR;
+}
+
+/* Anonymous mapping of 'size' bytes starting on an 'align' boundary */
+static char *map_aligned(size_t size, size_t align) {
+    char *raw, *start;
+    size_t head;
+
+    raw = mmap(NULL, size + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    start = (char *)(((uintptr_t)raw + align - 1) & ~(uintptr_t)(align - 1));
+    head = start - raw;
+    if (head > 0) munmap(raw, head);
+    munmap(start + size, align - head);
+    return start;
+}
+
+int ppm_arena_reserve(ppm_arena_t *arena, size_t bytes) {
+    ppm_pages_t pages;
+    size_t size;
+    char *base = NULL;
+
+    arena->used = 0;
+    if (arena->base != NULL && arena->size >= bytes) return 0;
+    ppm_arena_release(arena);
+
+    pages = requested_pages();
+    size = (bytes + PPM_HUGE_PAGE_SIZE - 1) / PPM_HUGE_PAGE_SIZE * PPM_HUGE_PAGE_SIZE;
+    if (size == 0) size = PPM_HUGE_PAGE_SIZE;
+
+    if (pages == PPM_PAGES_HUGETLB && MAP_HUGETLB != 0) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                    -1, 0);
+        if (base == MAP_FAILED) base = NULL;
+    }
+    if (base == NULL) {
+        if (pages == PPM_PAGES_HUGETLB) pages = PPM_PAGES_THP;
+        if ((base = map_aligned(size, PPM_HUGE_PAGE_SIZE)) == NULL) return -1;
+#ifdef MADV_HUGEPAGE
+        if (pages == PPM_PAGES_THP && madvise(base, size, MADV_HUGEPAGE) != 0) {
+            pages = PPM_PAGES_REGULAR;
+        }
+#else
+        pages = PPM_PAGES_REGULAR;
+#endif
+    }
+
+    arena->base = base;
+    arena->size = size;
+    arena->pages = pages;
+    return 0;
+}
+
+void *ppm_arena_grid(ppm_arena_t *arena, size_t rows, size_t pitch, size_t element_size) {
+    size_t bytes = ppm_grid_bytes(rows, pitch, element_size);
+    void *grid;
+
+    if (arena->base == NULL || arena->used + bytes > arena->size) return NULL;
+    grid = arena->base + arena->used;
+    arena->used += bytes;
+    return grid;
+}
+
+void ppm_arena_release(ppm_arena_t *arena) {
+    if (arena->base != NULL) munmap(arena->base, arena->size);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
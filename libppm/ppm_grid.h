@@ -0,0 +1,58 @@
+/*
+ * Grid storage: one arena per solver holding all of its grids
+ *
+ * Rows are padded to a pitch that is a multiple of PPM_ALIGN bytes (and never a multiple of
+ * 4 KiB, so the rows a stencil reads do not alias in the same cache sets) and every grid starts
+ * on a PPM_ALIGN boundary, so every row starts on a cache line. Index grids as
+ * grid[i * pitch + j]; the padding columns are never read.
+ *
+ * The arena is one anonymous mapping holding both buffers and their halo rows. Its pages are
+ * chosen with the PPM_HUGEPAGES environment variable:
+ *
+ *   thp (default)  transparent huge pages, requested with madvise(MADV_HUGEPAGE)
+ *   hugetlb        MAP_HUGETLB pages from the hugetlbfs pool, falling back to thp if the pool
+ *                  is empty
+ *   off            regular pages
+ *
+ * A driver running many problems reuses one arena: ppm_arena_reserve() only remaps when the
+ * next problem needs more memory than the current mapping holds.
+ */
+#ifndef PPM_GRID_H
+#define PPM_GRID_H
+
+#include <stddef.h>
+
+#define PPM_ALIGN 64
+#define PPM_HUGE_PAGE_SIZE (2UL << 20)
+
+typedef enum { PPM_PAGES_REGULAR, PPM_PAGES_THP, PPM_PAGES_HUGETLB } ppm_pages_t;
+
+typedef struct {
+    char *base;
+    size_t size;        // Bytes mapped
+    size_t used;        // Bytes handed out by ppm_arena_grid() since the last reserve
+    ppm_pages_t pages;  // Pages actually obtained
+} ppm_arena_t;
+
+#define PPM_ARENA_INIT {NULL, 0, 0, PPM_PAGES_REGULAR}
+
+const char *ppm_pages_name(ppm_pages_t pages);
+
+/* Row pitch, in elements, of rows of 'columns' elements of 'element_size' bytes */
+size_t ppm_pitch(size_t columns, size_t element_size);
+
+/* Arena bytes taken by one grid of 'rows' rows of 'pitch' elements */
+size_t ppm_grid_bytes(size_t rows, size_t pitch, size_t element_size);
+
+/* Make the arena hold at least 'bytes' and forget all grids handed out so far. Returns 0 on
+ * success and -1 if the memory cannot be mapped */
+int ppm_arena_reserve(ppm_arena_t *arena, size_t bytes);
+
+/* Next grid of 'rows' x 'pitch' elements from the arena, or NULL if it does not fit. The
+ * contents are undefined after a reuse: initialize with ppm_first_touch() */
+void *ppm_arena_grid(ppm_arena_t *arena, size_t rows, size_t pitch, size_t element_size);
+
+/* Unmap the arena */
+void ppm_arena_release(ppm_arena_t *arena);
+
+#endif  // PPM_GRID_H
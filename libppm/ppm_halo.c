@@ -0,0 +1,281 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ppm_codec.h"
+#include "ppm_instr.h"
+#include "ppm_slab.h"
+#include "ppm_topo.h"
+
+/* grid[0] and grid[1] of 'stride_rows' rows each from the slab arena, zeroed with the row
+ * partition of the sweep so their pages are placed on the NUMA node of the core that updates
+ * them */
+static int arena_grids(ppm_slab_t *slab, int stride_rows) {
+    size_t grid_bytes = ppm_grid_bytes(stride_rows, slab->pitch, sizeof(real_t));
+
+    if (ppm_arena_reserve(&slab->arena, 2 * grid_bytes) != 0) return -1;
+    slab->grid[0] = ppm_arena_grid(&slab->arena, stride_rows, slab->pitch, sizeof(real_t));
+    slab->grid[1] = ppm_arena_grid(&slab->arena, stride_rows, slab->pitch, sizeof(real_t));
+    ppm_first_touch(slab->grid[0], 2 * (size_t)stride_rows, sizeof(real_t) * slab->pitch);
+    return 0;
+}
+
+static int own_grids_setup(ppm_slab_t *slab) { return arena_grids(slab, slab->local_rows + 2); }
+
+static void own_grids_release(ppm_slab_t *slab) { (void)slab; }
+
+/*
+ * blocking: MPI_Sendrecv per neighbour through the halo codec
+ */
+static void blocking_exchange(ppm_slab_t *slab, real_t *grid) {
+    const size_t pitch = slab->pitch;
+    const int rank = slab->rank, last = slab->local_rows;
+
+    if (rank > 0) {
+        ppm_codec_sendrecv(&grid[pitch], &grid[0], slab->columns, rank - 1, rank, rank - 1,
+                           slab->comm);
+    }
+    if (rank < slab->size - 1) {
+        ppm_codec_sendrecv(&grid[last * pitch], &grid[(last + 1) * pitch], slab->columns,
+                           rank + 1, rank, rank + 1, slab->comm);
+    }
+}
+
+const ppm_halo_ops_t ppm_halo_blocking = {"blocking", 0, own_grids_setup, blocking_exchange,
+                                          NULL, own_grids_release};
+
+/*
+ * nonblocking: post all receives and sends, then wait for all of them
+ */
+static void nonblocking_exchange(ppm_slab_t *slab, real_t *grid) {
+    const size_t pitch = slab->pitch;
+    const int rank = slab->rank, last = slab->local_rows, m = slab->columns;
+    MPI_Request requests[4];
+    int num_requests = 0;
+
+    if (rank > 0) {
+        // Receive from rank - 1 into my top halo
+        MPI_Irecv(&grid[0], m, MPI_REAL_T, rank - 1, rank - 1, slab->comm,
+                  &requests[num_requests++]);
+        // Send my first real row to rank - 1
+        ppm_count_message(m, MPI_REAL_T);
+        MPI_Isend(&grid[pitch], m, MPI_REAL_T, rank - 1, rank, slab->comm,
+                  &requests[num_requests++]);
+    }
+    if (rank < slab->size - 1) {
+        // Receive from rank + 1 into my bottom halo
+        MPI_Irecv(&grid[(last + 1) * pitch], m, MPI_REAL_T, rank + 1, rank + 1, slab->comm,
+                  &requests[num_requests++]);
+        // Send my last real row to rank + 1
+        ppm_count_message(m, MPI_REAL_T);
+        MPI_Isend(&grid[last * pitch], m, MPI_REAL_T, rank + 1, rank, slab->comm,
+                  &requests[num_requests++]);
+    }
+
+    MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+}
+
+const ppm_halo_ops_t ppm_halo_nonblocking = {"nonblocking", 0,    own_grids_setup,
+                                             nonblocking_exchange, NULL, own_grids_release};
+
+/*
+ * rma: both grids are exposed through one window and every rank pushes its boundary rows into
+ * the neighbours' halos with MPI_Put, so there is no message matching and no
+ * unexpected-message queue
+ */
+typedef struct {
+    MPI_Win win;
+    MPI_Group neighbours;
+    MPI_Aint grid_stride;  // Elements from grid[0] to grid[1], the same on every rank
+    MPI_Aint bottom_disp;  // Bottom halo of rank - 1 within its grid
+} rma_state_t;
+
+static int rma_setup(ppm_slab_t *slab) {
+    rma_state_t *state;
+    MPI_Group slab_group;
+    int num_neighbours = 0, neighbour_ranks[2];
+
+    if ((state = (rma_state_t *)malloc(sizeof(rma_state_t))) == NULL) return -1;
+    slab->halo_state = state;
+
+    // Every rank uses the stride of the largest slab, so the target displacement of a halo row
+    // only depends on which of the two grids is current, which is the same on all ranks
+    if (arena_grids(slab, slab->max_local_rows + 2) != 0) return -1;
+    state->grid_stride = slab->grid[1] - slab->grid[0];
+
+    // A single rank has no halos to exchange (and some MPI builds cannot create a window on
+    // one process), so the window is only created when there are neighbours
+    if (slab->size > 1) {
+        MPI_Win_create(slab->grid[0], sizeof(real_t) * 2 * state->grid_stride, sizeof(real_t),
+                       MPI_INFO_NULL, slab->comm, &state->win);
+    }
+
+    // Access and exposure epochs only involve the neighbouring ranks
+    if (slab->rank > 0) neighbour_ranks[num_neighbours++] = slab->rank - 1;
+    if (slab->rank < slab->size - 1) neighbour_ranks[num_neighbours++] = slab->rank + 1;
+    MPI_Comm_group(slab->comm, &slab_group);
+    MPI_Group_incl(slab_group, num_neighbours, neighbour_ranks, &state->neighbours);
+    MPI_Group_free(&slab_group);
+
+    // My first real row goes to the bottom halo of rank - 1, my last real row to the top halo
+    // (row 0) of rank + 1
+    state->bottom_disp = 0;
+    if (slab->rank > 0) {
+        state->bottom_disp =
+            (MPI_Aint)(ppm_slab_partition(slab->rows, slab->size, slab->rank - 1, NULL) + 1) *
+            slab->pitch;
+    }
+    return 0;
+}
+
+static void rma_exchange(ppm_slab_t *slab, real_t *grid) {
+    rma_state_t *state = slab->halo_state;
+    const size_t pitch = slab->pitch;
+    const int rank = slab->rank, last = slab->local_rows, m = slab->columns;
+    MPI_Aint buffer_disp = grid == slab->grid[0] ? 0 : state->grid_stride;
+
+    if (slab->size == 1) return;
+
+    // The exposure epoch opens once my sweep is done, so neighbours never write into a grid I
+    // am still reading, and it closes before my next sweep reads the halos
+    MPI_Win_post(state->neighbours, 0, state->win);
+    MPI_Win_start(state->neighbours, 0, state->win);
+    if (rank > 0) {
+        ppm_count_message(m, MPI_REAL_T);
+        MPI_Put(&grid[pitch], m, MPI_REAL_T, rank - 1, buffer_disp + state->bottom_disp, m,
+                MPI_REAL_T, state->win);
+    }
+    if (rank < slab->size - 1) {
+        ppm_count_message(m, MPI_REAL_T);
+        MPI_Put(&grid[last * pitch], m, MPI_REAL_T, rank + 1, buffer_disp, m, MPI_REAL_T,
+                state->win);
+    }
+    MPI_Win_complete(state->win);
+    MPI_Win_wait(state->win);
+}
+
+static void rma_release(ppm_slab_t *slab) {
+    rma_state_t *state = slab->halo_state;
+
+    if (state == NULL) return;
+    if (slab->grid[1] != NULL) {
+        MPI_Group_free(&state->neighbours);
+        if (slab->size > 1) MPI_Win_free(&state->win);
+    }
+    free(state);
+}
+
+const ppm_halo_ops_t ppm_halo_rma = {"rma", 0, rma_setup, rma_exchange, NULL, rma_release};
+
+/*
+ * shm: ranks on the same node allocate their grids in one shared-memory window and read the
+ * boundary rows of on-node neighbours straight from their segments. Only boundaries between
+ * nodes go through MPI_Sendrecv, so a single-node run sends no halo messages at all
+ */
+typedef struct {
+    MPI_Win win;
+    MPI_Comm node_comm;
+} shm_state_t;
+
+static int shm_setup(ppm_slab_t *slab) {
+    shm_state_t *state;
+    MPI_Group slab_group, node_group;
+    MPI_Info win_info;
+    MPI_Aint grid_stride, segment_size;
+    real_t *grids, *neighbour_grids;
+    int node_neighbours[2], slab_neighbours[2], disp_unit, p, rc;
+
+    if ((state = (shm_state_t *)malloc(sizeof(shm_state_t))) == NULL) return -1;
+
+    // Both grids with the stride of the largest slab so a neighbour's row is found at the same
+    // offset on every rank. Segments are only reached through MPI_Win_shared_query, so they
+    // need not be contiguous and each one can start on a page of its own
+    MPI_Comm_split_type(slab->comm, MPI_COMM_TYPE_SHARED, slab->rank, MPI_INFO_NULL,
+                        &state->node_comm);
+    grid_stride = (MPI_Aint)(slab->max_local_rows + 2) * slab->pitch;
+    MPI_Info_create(&win_info);
+    MPI_Info_set(win_info, "alloc_shared_noncontig", "true");
+    rc = MPI_Win_allocate_shared(sizeof(real_t) * 2 * grid_stride, sizeof(real_t), win_info,
+                                 state->node_comm, &grids, &state->win);
+    MPI_Info_free(&win_info);
+    if (rc != MPI_SUCCESS) {
+        MPI_Comm_free(&state->node_comm);
+        free(state);
+        return -1;
+    }
+    slab->halo_state = state;
+    slab->grid[0] = grids;
+    slab->grid[1] = grids + grid_stride;
+
+    // Every rank zeroes its own segment, not node rank 0
+    ppm_first_touch(grids, 2 * (size_t)(slab->max_local_rows + 2), sizeof(real_t) * slab->pitch);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, state->win);
+
+    slab_neighbours[0] = slab->rank > 0 ? slab->rank - 1 : MPI_PROC_NULL;
+    slab_neighbours[1] = slab->rank < slab->size - 1 ? slab->rank + 1 : MPI_PROC_NULL;
+    MPI_Comm_group(slab->comm, &slab_group);
+    MPI_Comm_group(state->node_comm, &node_group);
+    MPI_Group_translate_ranks(slab_group, 2, slab_neighbours, node_group, node_neighbours);
+    MPI_Group_free(&slab_group);
+    MPI_Group_free(&node_group);
+
+    if (node_neighbours[0] != MPI_UNDEFINED && node_neighbours[0] != MPI_PROC_NULL) {
+        MPI_Win_shared_query(state->win, node_neighbours[0], &segment_size, &disp_unit,
+                             &neighbour_grids);
+        // Last real row of rank - 1
+        for (p = 0; p < 2; p++) {
+            slab->up[p] =
+                neighbour_grids + p * grid_stride +
+                (MPI_Aint)ppm_slab_partition(slab->rows, slab->size, slab->rank - 1, NULL) *
+                    slab->pitch;
+        }
+    }
+    if (node_neighbours[1] != MPI_UNDEFINED && node_neighbours[1] != MPI_PROC_NULL) {
+        MPI_Win_shared_query(state->win, node_neighbours[1], &segment_size, &disp_unit,
+                             &neighbour_grids);
+        // First real row of rank + 1 is always row 1
+        for (p = 0; p < 2; p++) slab->down[p] = neighbour_grids + p * grid_stride + slab->pitch;
+    }
+    return 0;
+}
+
+static void shm_sync(ppm_slab_t *slab) { MPI_Win_sync(((shm_state_t *)slab->halo_state)->win); }
+
+static void shm_exchange(ppm_slab_t *slab, real_t *grid) {
+    const size_t pitch = slab->pitch;
+    const int rank = slab->rank, last = slab->local_rows;
+
+    // Make my new grid visible to the on-node neighbours before the reduction releases them
+    shm_sync(slab);
+
+    // Halo messages only with neighbours on other nodes
+    if (rank > 0 && slab->up[0] == NULL) {
+        ppm_codec_sendrecv(&grid[pitch], &grid[0], slab->columns, rank - 1, rank, rank - 1,
+                           slab->comm);
+    }
+    if (rank < slab->size - 1 && slab->down[0] == NULL) {
+        ppm_codec_sendrecv(&grid[last * pitch], &grid[(last + 1) * pitch], slab->columns,
+                           rank + 1, rank, rank + 1, slab->comm);
+    }
+}
+
+static void shm_release(ppm_slab_t *slab) {
+    shm_state_t *state = slab->halo_state;
+
+    MPI_Win_unlock_all(state->win);
+    MPI_Win_free(&state->win);
+    MPI_Comm_free(&state->node_comm);
+    free(state);
+}
+
+const ppm_halo_ops_t ppm_halo_shm = {"shm", 1, shm_setup, shm_exchange, shm_sync, shm_release};
+
+const ppm_halo_ops_t *ppm_halo_find(const char *name) {
+    static const ppm_halo_ops_t *strategies[] = {&ppm_halo_blocking, &ppm_halo_nonblocking,
+                                                 &ppm_halo_rma, &ppm_halo_shm};
+    size_t s;
+
+    for (s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++) {
+        if (strcmp(strategies[s]->name, name) == 0) return strategies[s];
+    }
+    return NULL;
+}
@@ -0,0 +1,117 @@
+#include "ppm_instr.h"
+
+#include <string.h>
+
+#include "ppm_perf.h"
+#include "ppm_trace.h"
+#include "ppm_wait.h"
+
+static const char *phase_names[PPM_NUM_PHASES] = {"sweep", "halo",   "reduce", "focal",
+                                                  "team",  "gather", "pack"};
+
+static double total_start;
+static double total_time;
+static double phase_start[PPM_NUM_PHASES];
+static double phase_time[PPM_NUM_PHASES];
+static long long messages_sent;
+static long long bytes_sent;
+
+const char *ppm_phase_name(ppm_phase_t phase) { return phase_names[phase]; }
+
+void ppm_instr_init(void) {
+    memset(phase_start, 0, sizeof(phase_start));
+    memset(phase_time, 0, sizeof(phase_time));
+    messages_sent = 0;
+    bytes_sent = 0;
+    total_time = 0.0;
+    ppm_wait_init();
+    ppm_trace_init();
+    ppm_perf_init();
+    total_start = MPI_Wtime();
+}
+
+double ppm_common_origin(void) {
+    MPI_Comm node_comm;
+    double origin;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    origin = MPI_Wtime();
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    MPI_Bcast(&origin, 1, MPI_DOUBLE, 0, node_comm);
+    MPI_Comm_free(&node_comm);
+    return origin;
+}
+
+void ppm_phase_begin(ppm_phase_t phase) {
+    if (phase == PPM_PHASE_SWEEP) ppm_perf_start();
+    phase_start[phase] = MPI_Wtime();
+}
+
+void ppm_phase_end(ppm_phase_t phase) {
+    double now = MPI_Wtime();
+
+    if (phase == PPM_PHASE_SWEEP) ppm_perf_stop(now - phase_start[phase]);
+    phase_time[phase] += now - phase_start[phase];
+    ppm_trace_event(phase, phase_start[phase], now);
+}
+
+void ppm_count_message(int count, MPI_Datatype type) {
+    int type_size;
+
+    MPI_Type_size(type, &type_size);
+    messages_sent++;
+    bytes_sent += (long long)count * type_size;
+}
+
+/* Reduce one per-rank value to min/avg/max across 'comm' */
+static void reduce_stat(MPI_Comm comm, int size, double value, ppm_stat_t *stat) {
+    double sum;
+
+    MPI_Allreduce(&value, &stat->min, 1, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(&value, &stat->max, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&value, &sum, 1, MPI_DOUBLE, MPI_SUM, comm);
+    stat->avg = sum / size;
+}
+
+void ppm_instr_summarize(MPI_Comm comm, ppm_summary_t *summary) {
+    int size, p;
+    double comm_time;
+
+    total_time = MPI_Wtime() - total_start;
+    comm_time = phase_time[PPM_PHASE_HALO] + phase_time[PPM_PHASE_REDUCE] +
+                phase_time[PPM_PHASE_GATHER];
+
+    MPI_Comm_size(comm, &size);
+    summary->ranks = size;
+
+    reduce_stat(comm, size, total_time, &summary->total);
+    reduce_stat(comm, size, comm_time, &summary->comm);
+    reduce_stat(comm, size, total_time - comm_time, &summary->comp);
+    for (p = 0; p < PPM_NUM_PHASES; p++) {
+        reduce_stat(comm, size, phase_time[p], &summary->phase[p]);
+    }
+    reduce_stat(comm, size, (double)messages_sent, &summary->messages);
+    reduce_stat(comm, size, (double)bytes_sent, &summary->bytes);
+}
+
+static void print_stat(FILE *out, const char *name, const ppm_stat_t *stat) {
+    fprintf(out, " %s_min=%.6f %s_avg=%.6f %s_max=%.6f", name, stat->min, name, stat->avg, name,
+            stat->max);
+}
+
+void ppm_instr_print(FILE *out, const ppm_summary_t *summary) {
+    int p;
+
+    fprintf(out, "Profile: ranks=%d", summary->ranks);
+    print_stat(out, "total", &summary->total);
+    print_stat(out, "comm", &summary->comm);
+    print_stat(out, "comp", &summary->comp);
+    for (p = 0; p < PPM_NUM_PHASES; p++) {
+        print_stat(out, phase_names[p], &summary->phase[p]);
+    }
+    fprintf(out, " messages_min=%.0f messages_avg=%.1f messages_max=%.0f", summary->messages.min,
+            summary->messages.avg, summary->messages.max);
+    fprintf(out, " bytes_min=%.0f bytes_avg=%.1f bytes_max=%.0f\n", summary->bytes.min,
+            summary->bytes.avg, summary->bytes.max);
+    fflush(out);
+}
@@ -0,0 +1,66 @@
+/*
+ * Lightweight always-on instrumentation for the MPI solvers
+ *
+ * Every rank accumulates MPI_Wtime() based timers per phase plus counters of the messages and
+ * bytes it sends. At the end of the run the per-rank values are reduced to min/avg/max across
+ * the communicator and rank 0 prints them as a single machine-readable line:
+ *
+ *     Profile: ranks=4 total_min=... total_avg=... total_max=... sweep_min=... ...
+ */
+#ifndef PPM_INSTR_H
+#define PPM_INSTR_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+/* Phases timed by the solvers. Not every solver uses every phase */
+typedef enum {
+    PPM_PHASE_SWEEP,   // Stencil update and local error/residual computation
+    PPM_PHASE_HALO,    // Halo row exchange with the neighbouring ranks
+    PPM_PHASE_REDUCE,  // Global reductions (error, residual, counters)
+    PPM_PHASE_FOCAL,   // Fire simulator: heat update on the active focal points
+    PPM_PHASE_TEAM,    // Fire simulator: team movement and team actions
+    PPM_PHASE_GATHER,  // Collection of the distributed result on rank 0
+    PPM_PHASE_PACK,    // Halo compression and decompression (nested inside PPM_PHASE_HALO)
+    PPM_NUM_PHASES
+} ppm_phase_t;
+
+/* Reduced statistics of one quantity across all ranks */
+typedef struct {
+    double min, avg, max;
+} ppm_stat_t;
+
+/* Per-run summary produced by ppm_instr_summarize() */
+typedef struct {
+    int ranks;
+    ppm_stat_t total;
+    ppm_stat_t comm;  // halo + reduce + gather
+    ppm_stat_t comp;  // total - comm
+    ppm_stat_t phase[PPM_NUM_PHASES];
+    ppm_stat_t messages;
+    ppm_stat_t bytes;
+} ppm_summary_t;
+
+const char *ppm_phase_name(ppm_phase_t phase);
+
+/* Reset all timers and counters and start the total timer. Call right after MPI_Init */
+void ppm_instr_init(void);
+
+/* MPI_Wtime() origin shared by all ranks, for timestamps compared across ranks: the ranks of a
+ * node share its clock and take the origin of their node leader, and the leaders align through
+ * a barrier (a few microseconds apart). Collective over MPI_COMM_WORLD */
+double ppm_common_origin(void);
+
+void ppm_phase_begin(ppm_phase_t phase);
+void ppm_phase_end(ppm_phase_t phase);
+
+/* Account for one outgoing message of 'count' elements of 'type' */
+void ppm_count_message(int count, MPI_Datatype type);
+
+/* Stop the total timer and reduce the per-rank values across 'comm'. Collective */
+void ppm_instr_summarize(MPI_Comm comm, ppm_summary_t *summary);
+
+/* Print the "Profile:" line of a summary */
+void ppm_instr_print(FILE *out, const ppm_summary_t *summary);
+
+#endif  // PPM_INSTR_H
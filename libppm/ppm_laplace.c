@@ -0,0 +1,93 @@
+#include "ppm_laplace.h"
+
+#include "ppm_instr.h"
+#include "ppm_report.h"
+#include "ppm_stencil.h"
+
+void ppm_laplace_init(ppm_laplace_t *solver, MPI_Comm comm, const ppm_halo_ops_t *halo) {
+    ppm_slab_init(&solver->slab, comm, halo);
+    solver->n = solver->m = 0;
+    solver->iter = 0;
+    solver->current = 0;
+    solver->error = 1.0;
+}
+
+int ppm_laplace_setup(ppm_laplace_t *solver, int n, int m) {
+    ppm_slab_t *slab = &solver->slab;
+    int p;
+
+    if (ppm_slab_setup(slab, n, m) != 0) return -1;
+
+    solver->n = n;
+    solver->m = m;
+    solver->iter = 0;
+    solver->current = 0;
+    solver->error = 1.0;
+
+    // Boundary conditions of every stored row, halos included, so the first sweep reads the
+    // same halo values an exchange would bring (the interior is already zero)
+    for (p = 0; p < 2; p++) {
+        ppm_laplace_boundary(slab->grid[p], slab->pitch, slab->local_rows + 2,
+                             slab->first_row - 1, n, m);
+    }
+
+    // Neighbours must see my initial grids before the first sweep reads them
+    ppm_slab_publish(slab);
+    return 0;
+}
+
+void ppm_laplace_step(ppm_laplace_t *solver) {
+    ppm_slab_t *slab = &solver->slab;
+    int p = solver->current, begin = 1, end = slab->local_rows + 1;
+
+    // Global rows 0 and n - 1 are fixed
+    if (slab->first_row == 0) begin++;
+    if (slab->first_row + slab->local_rows == solver->n) end--;
+
+    ppm_phase_begin(PPM_PHASE_SWEEP);
+    solver->error = ppm_laplace_sweep(slab->grid[p], slab->grid[1 - p], slab->pitch, begin, end,
+                                      solver->m, slab->up[p], slab->down[p]);
+    ppm_phase_end(PPM_PHASE_SWEEP);
+
+    solver->current = 1 - p;
+}
+
+void ppm_laplace_exchange(ppm_laplace_t *solver) {
+    ppm_slab_exchange(&solver->slab, solver->slab.grid[solver->current]);
+}
+
+acc_t ppm_laplace_reduce(ppm_laplace_t *solver) {
+    ppm_slab_allreduce(&solver->slab, &solver->error, 1, MPI_ACC_T, MPI_MAX);
+    solver->iter++;
+    return solver->error;
+}
+
+int ppm_laplace_run(ppm_laplace_t *solver, int iter_max, acc_t tol, FILE *log) {
+    while (solver->error > tol && solver->iter < iter_max) {
+        ppm_laplace_step(solver);
+        ppm_laplace_exchange(solver);
+        ppm_laplace_reduce(solver);
+
+        if (log != NULL && solver->iter % 10 == 0 && solver->slab.rank == 0) {
+            fprintf(log, "Iteration %i -> Error = %f\n", solver->iter, ACC_SQRT(solver->error));
+        }
+    }
+    return solver->iter;
+}
+
+void ppm_laplace_report(ppm_laplace_t *solver, const char *variant) {
+    const int n = solver->n, m = solver->m, iter = solver->iter;
+
+    // Each interior point costs 6 flops (4 stencil + 2 error) and streams one load of A and
+    // one store of Anew
+    ppm_run_info_t info = {variant,
+                           n,
+                           m,
+                           iter,
+                           ACC_SQRT(solver->error),
+                           6.0 * (n - 2) * (m - 2) * iter,
+                           2.0 * sizeof(real_t) * (n - 2) * (m - 2) * iter};
+    ppm_report(solver->slab.comm, &info);
+}
+
+void ppm_laplace_finalize(ppm_laplace_t *solver) { ppm_slab_finalize(&solver->slab); }
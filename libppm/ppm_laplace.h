@@ -0,0 +1,66 @@
+/*
+ * Distributed Laplace solver
+ *
+ * Jacobi iterations on an n x m grid split in row slabs (ppm_slab.h), with the halo exchange
+ * strategy chosen by the caller. A solver is initialized once per communicator and can solve
+ * any number of problems in turn without reallocating:
+ *
+ *     ppm_laplace_init(&solver, MPI_COMM_WORLD, &ppm_halo_rma);
+ *     for (each problem) {
+ *         ppm_laplace_setup(&solver, n, m);
+ *         ppm_laplace_run(&solver, iter_max, PPM_LAPLACE_TOL, NULL);  // or, per iteration:
+ *         //   ppm_laplace_step(); ppm_laplace_exchange(); ppm_laplace_reduce();
+ *     }
+ *     ppm_laplace_finalize(&solver);
+ *
+ * The error is the maximum absolute change of the last sweep. The usual tolerance is
+ * PPM_LAPLACE_TOL; the solvers print and report its square root.
+ */
+#ifndef PPM_LAPLACE_H
+#define PPM_LAPLACE_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+#include "ppm_real.h"
+#include "ppm_slab.h"
+
+#define PPM_LAPLACE_TOL (1.0e-3f * 1.0e-3f)
+
+typedef struct {
+    ppm_slab_t slab;
+    int n, m;     // Global grid
+    int iter;     // Iterations done since ppm_laplace_setup()
+    int current;  // slab.grid[current] holds the latest values
+    acc_t error;  // Local error after ppm_laplace_step(), global after ppm_laplace_reduce()
+} ppm_laplace_t;
+
+/* Create the slab communicator of 'comm' for the given halo strategy. Collective */
+void ppm_laplace_init(ppm_laplace_t *solver, MPI_Comm comm, const ppm_halo_ops_t *halo);
+
+/* Start a new n x m problem: zero interior, boundary conditions, iteration 0. Returns -1 if
+ * the grid cannot be decomposed or allocated. Collective */
+int ppm_laplace_setup(ppm_laplace_t *solver, int n, int m);
+
+/* One Jacobi sweep into the other grid, which becomes the current one. Local */
+void ppm_laplace_step(ppm_laplace_t *solver);
+
+/* Exchange the halos of the current grid. Collective */
+void ppm_laplace_exchange(ppm_laplace_t *solver);
+
+/* Reduce the error across all ranks and count the iteration; returns the global error.
+ * Collective */
+acc_t ppm_laplace_reduce(ppm_laplace_t *solver);
+
+/* Iterate until the error is at most 'tol' or 'iter_max' iterations were done, printing the
+ * error every 10 iterations to 'log' on rank 0 if not NULL. Returns the iterations done.
+ * Collective */
+int ppm_laplace_run(ppm_laplace_t *solver, int iter_max, acc_t tol, FILE *log);
+
+/* ppm_report() the current problem as solver 'variant'. Collective */
+void ppm_laplace_report(ppm_laplace_t *solver, const char *variant);
+
+/* Free the grids and the slab communicator. Collective */
+void ppm_laplace_finalize(ppm_laplace_t *solver);
+
+#endif  // PPM_LAPLACE_H
@@ -0,0 +1,173 @@
+#include "ppm_perf.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define CACHE_LINE 64
+
+/* Counters, then the derived values of the report */
+enum { CYCLES, INSTRUCTIONS, LLC_LOADS, LLC_MISSES, LLC_STORE_MISSES, NUM_COUNTERS };
+enum { SWEEP_TIME = NUM_COUNTERS, IPC, MEM_GBYTES_PER_S, NUM_VALUES };
+
+static const char *value_names[NUM_VALUES] = {"cycles",     "instructions",     "llc_loads",
+                                               "llc_misses", "llc_store_misses", "sweep_time",
+                                               "ipc",        "mem_gbytes_per_s"};
+
+static int requested, opened;
+static int open_errno;  // of the last counter that failed to open
+static int fds[NUM_COUNTERS];
+static double kernel_time;
+
+#ifdef __linux__
+#define LLC_EVENT(op, result)                                                 \
+    (PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_##op << 8) |            \
+     (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} events[NUM_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, LLC_EVENT(READ, ACCESS)},
+    {PERF_TYPE_HW_CACHE, LLC_EVENT(READ, MISS)},
+    {PERF_TYPE_HW_CACHE, LLC_EVENT(WRITE, MISS)},
+};
+
+static int open_counter(int c) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[c].type;
+    attr.config = events[c].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Scaled by the time the counter was actually scheduled if the PMU has to multiplex
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Scaled count of counter 'c', -1 if it is not available */
+static double read_counter(int c) {
+    uint64_t values[3];
+
+    if (fds[c] < 0 || read(fds[c], values, sizeof(values)) != sizeof(values)) return -1.0;
+    if (values[2] == 0) return 0.0;
+    return (double)values[0] * ((double)values[1] / (double)values[2]);
+}
+#endif
+
+void ppm_perf_init(void) {
+    const char *env = getenv("PPM_PERF");
+    int c;
+
+    requested = env != NULL && env[0] != '\0' && strcmp(env, "0") != 0;
+    kernel_time = 0.0;
+    for (c = 0; c < NUM_COUNTERS; c++) {
+#ifdef __linux__
+        if (opened && fds[c] >= 0) close(fds[c]);
+        fds[c] = requested ? open_counter(c) : -1;
+        if (requested && fds[c] < 0) open_errno = errno;
+#else
+        open_errno = ENOSYS;
+        fds[c] = -1;
+#endif
+    }
+    opened = 1;
+}
+
+void ppm_perf_start(void) {
+#ifdef __linux__
+    // One system call switches on every counter of this thread
+    if (requested) prctl(PR_TASK_PERF_EVENTS_ENABLE);
+#endif
+}
+
+void ppm_perf_stop(double seconds) {
+    if (!requested) return;
+#ifdef __linux__
+    prctl(PR_TASK_PERF_EVENTS_DISABLE);
+#endif
+    kernel_time += seconds;
+}
+
+static void print_value(FILE *out, int v, double value) {
+    if (v == IPC) {
+        fprintf(out, " %s=%.3f", value_names[v], value);
+    } else if (v == SWEEP_TIME || v == MEM_GBYTES_PER_S) {
+        fprintf(out, " %s=%.6f", value_names[v], value);
+    } else {
+        fprintf(out, " %s=%.0f", value_names[v], value);
+    }
+}
+
+void ppm_perf_report(MPI_Comm comm, FILE *out) {
+    double mine[NUM_VALUES], min[NUM_VALUES], max[NUM_VALUES], sum[NUM_VALUES];
+    double *all = NULL;
+    int rank, size, r, v;
+
+    if (!requested) return;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    for (v = 0; v < NUM_COUNTERS; v++) {
+#ifdef __linux__
+        mine[v] = read_counter(v);
+#else
+        mine[v] = -1.0;
+#endif
+    }
+    mine[SWEEP_TIME] = kernel_time;
+    mine[IPC] = mine[CYCLES] > 0.0 && mine[INSTRUCTIONS] >= 0.0
+                    ? mine[INSTRUCTIONS] / mine[CYCLES]
+                    : -1.0;
+    mine[MEM_GBYTES_PER_S] =
+        mine[LLC_MISSES] >= 0.0 && mine[LLC_STORE_MISSES] >= 0.0 && kernel_time > 0.0
+            ? (mine[LLC_MISSES] + mine[LLC_STORE_MISSES]) * CACHE_LINE / kernel_time * 1e-9
+            : -1.0;
+
+    if (rank == 0) {
+        all = (double *)malloc(sizeof(double) * NUM_VALUES * size);
+        if (all == NULL) {
+            fprintf(stderr, "-- Error allocating: counters of %d ranks\n", size);
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+    MPI_Gather(mine, NUM_VALUES, MPI_DOUBLE, all, NUM_VALUES, MPI_DOUBLE, 0, comm);
+    MPI_Reduce(mine, min, NUM_VALUES, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(mine, max, NUM_VALUES, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(mine, sum, NUM_VALUES, MPI_DOUBLE, MPI_SUM, 0, comm);
+    if (rank != 0) return;
+
+    if (max[CYCLES] < 0.0 && max[INSTRUCTIONS] < 0.0 && max[LLC_LOADS] < 0.0) {
+        fprintf(stderr, "-- Warning: no hardware counters (rank 0: %s)\n", strerror(open_errno));
+    }
+    for (r = 0; r < size; r++) {
+        fprintf(out, "Counters rank %d:", r);
+        for (v = SWEEP_TIME; v < NUM_VALUES; v++) print_value(out, v, all[r * NUM_VALUES + v]);
+        for (v = 0; v < NUM_COUNTERS; v++) print_value(out, v, all[r * NUM_VALUES + v]);
+        fprintf(out, "\n");
+    }
+    // A counter missing on any rank is missing in the reduced values too
+    fprintf(out, "Counters: ranks=%d", size);
+    for (v = 0; v < NUM_VALUES; v++) {
+        int missing = min[v] < 0.0;
+        fprintf(out, " %s_min=%.6g %s_avg=%.6g %s_max=%.6g", value_names[v],
+                missing ? -1.0 : min[v], value_names[v], missing ? -1.0 : sum[v] / size,
+                value_names[v], missing ? -1.0 : max[v]);
+    }
+    fprintf(out, "\n");
+    fflush(out);
+    free(all);
+}
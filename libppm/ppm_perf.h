@@ -0,0 +1,36 @@
+/*
+ * Hardware counters of the stencil kernel
+ *
+ * With PPM_PERF=1 every rank opens, with perf_event_open(2), counters of its own user-space
+ * work: cycles, instructions, last-level cache loads, load misses and store misses. They count
+ * only inside the sweep phase of ppm_instr.h (the stencil update and local error/residual), not
+ * in MPI_Init, the halo exchanges or the launcher, as `perf stat mpirun ...` does. At the end of
+ * the run ppm_report() prints, on rank 0, one line per rank and the min/avg/max over ranks:
+ *
+ *     Counters rank 0: sweep_time=... cycles=... instructions=... ipc=... llc_loads=...
+ *     Counters: ranks=4 cycles_min=... cycles_avg=... cycles_max=... ... mem_gbytes_per_s_max=...
+ *
+ * mem_gbytes_per_s, the memory bandwidth proxy, is (LLC load + store misses) x 64 bytes over the
+ * sweep time. Counters the CPU or the kernel do not offer (virtual machines, perf_event_paranoid
+ * above 2) print as -1. Only the thread that calls MPI counts: in hybrid builds the OpenMP
+ * workers are left out. Linux only.
+ */
+#ifndef PPM_PERF_H
+#define PPM_PERF_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+/* Read PPM_PERF and, if set, open the counters, disabled. Called by ppm_instr_init() */
+void ppm_perf_init(void);
+
+/* Count from here to ppm_perf_stop(), which adds 'seconds' to the kernel time. Called by
+ * ppm_phase_begin() and ppm_phase_end() for the sweep phase */
+void ppm_perf_start(void);
+void ppm_perf_stop(double seconds);
+
+/* Print the per-rank and reduced counters of 'comm' on its rank 0. Does nothing unless
+ * PPM_PERF is set. Collective */
+void ppm_perf_report(MPI_Comm comm, FILE *out);
+
+#endif  // PPM_PERF_H
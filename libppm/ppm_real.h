@@ -0,0 +1,53 @@
+/*
+ * Element type of the Laplace grids, selected at compile time
+ *
+ *   (default)    float storage, float arithmetic  - MPI_FLOAT halos and reductions
+ *   -DPPM_DOUBLE double storage, double arithmetic - MPI_DOUBLE halos and reductions
+ *   -DPPM_MIXED  float storage, double arithmetic  - MPI_FLOAT halos, MPI_DOUBLE reductions
+ *
+ * real_t is what the grids store and the halos carry, acc_t what the stencil sums and the
+ * error are computed in. The default build is bit-for-bit the original float solver.
+ */
+#ifndef PPM_REAL_H
+#define PPM_REAL_H
+
+#include <math.h>
+
+#if defined(PPM_DOUBLE) && defined(PPM_MIXED)
+#error "PPM_DOUBLE and PPM_MIXED are mutually exclusive"
+#endif
+
+#if defined(PPM_DOUBLE)
+typedef double real_t;
+typedef double acc_t;
+#define MPI_REAL_T MPI_DOUBLE
+#define MPI_ACC_T MPI_DOUBLE
+#define PPM_PRECISION "double"
+#elif defined(PPM_MIXED)
+typedef float real_t;
+typedef double acc_t;
+#define MPI_REAL_T MPI_FLOAT
+#define MPI_ACC_T MPI_DOUBLE
+#define PPM_PRECISION "mixed"
+#else
+typedef float real_t;
+typedef float acc_t;
+#define MPI_REAL_T MPI_FLOAT
+#define MPI_ACC_T MPI_FLOAT
+#define PPM_PRECISION "float"
+#endif
+
+/* Math on acc_t values */
+#if defined(PPM_DOUBLE) || defined(PPM_MIXED)
+#define ACC_FABS fabs
+#define ACC_FMAX fmax
+#define ACC_SQRT sqrt
+#define ACC_SIN sin
+#else
+#define ACC_FABS fabsf
+#define ACC_FMAX fmaxf
+#define ACC_SQRT sqrtf
+#define ACC_SIN sinf
+#endif
+
+#endif  // PPM_REAL_H
@@ -0,0 +1,142 @@
+#include "ppm_report.h"
+
+#include "ppm_perf.h"
+#include "ppm_real.h"
+#include "ppm_trace.h"
+#include "ppm_wait.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int ppm_count_nodes(MPI_Comm comm) {
+    MPI_Comm node_comm;
+    int node_rank, is_leader, nodes;
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_free(&node_comm);
+
+    is_leader = node_rank == 0;
+    MPI_Allreduce(&is_leader, &nodes, 1, MPI_INT, MPI_SUM, comm);
+
+    return nodes;
+}
+
+/* OpenMP threads per rank: more than one only in hybrid builds */
+static int report_threads(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static int has_suffix(const char *str, const char *suffix) {
+    size_t len = strlen(str), suffix_len = strlen(suffix);
+
+    return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+static void write_csv(FILE *out, const ppm_run_info_t *info, const ppm_summary_t *summary,
+                      int nodes, const char *machine, const char *timestamp) {
+    const double total = summary->total.avg;
+    const double wall = summary->total.max;
+    int p;
+
+    /* New or empty file: write the header first */
+    if (ftell(out) == 0) {
+        fprintf(out,
+                "processors,nodes,total_time,comm_time,comp_time,comm_percent,variant,precision,"
+                "threads,rows,columns,iterations,error,total_time_max,gflops,gbytes_per_s");
+        for (p = 0; p < PPM_NUM_PHASES; p++) fprintf(out, ",%s_time", ppm_phase_name(p));
+        fprintf(out, ",messages,bytes_sent,machine,commit,timestamp\n");
+    }
+
+    fprintf(out, "%d,%d,%.4f,%.4f,%.4f,%.2f,%s,%s,%d,%d,%d,%d,%.6f,%.4f,%.4f,%.4f",
+            summary->ranks, nodes, total, summary->comm.avg, summary->comp.avg,
+            total > 0.0 ? summary->comm.avg / total * 100 : 0.0, info->variant, PPM_PRECISION,
+            report_threads(), info->rows,
+            info->columns, info->iterations, info->error, wall,
+            wall > 0.0 ? info->flops / wall * 1e-9 : 0.0,
+            wall > 0.0 ? info->bytes / wall * 1e-9 : 0.0);
+    for (p = 0; p < PPM_NUM_PHASES; p++) fprintf(out, ",%.4f", summary->phase[p].avg);
+    fprintf(out, ",%.0f,%.0f,%s,%s,%s\n", summary->messages.avg * summary->ranks,
+            summary->bytes.avg * summary->ranks, machine, PPM_COMMIT, timestamp);
+}
+
+static void write_json(FILE *out, const ppm_run_info_t *info, const ppm_summary_t *summary,
+                       int nodes, const char *machine, const char *timestamp) {
+    const double total = summary->total.avg;
+    const double wall = summary->total.max;
+    int p;
+
+    fprintf(out, "{\"variant\": \"%s\", \"precision\": \"%s\", \"processors\": %d, \"nodes\": %d",
+            info->variant, PPM_PRECISION, summary->ranks, nodes);
+    fprintf(out, ", \"threads\": %d", report_threads());
+    fprintf(out, ", \"rows\": %d, \"columns\": %d, \"iterations\": %d, \"error\": %.6f",
+            info->rows, info->columns, info->iterations, info->error);
+    fprintf(out,
+            ", \"total_time\": %.4f, \"comm_time\": %.4f, \"comp_time\": %.4f"
+            ", \"comm_percent\": %.2f, \"total_time_max\": %.4f",
+            total, summary->comm.avg, summary->comp.avg,
+            total > 0.0 ? summary->comm.avg / total * 100 : 0.0, wall);
+    fprintf(out, ", \"gflops\": %.4f, \"gbytes_per_s\": %.4f",
+            wall > 0.0 ? info->flops / wall * 1e-9 : 0.0,
+            wall > 0.0 ? info->bytes / wall * 1e-9 : 0.0);
+    fprintf(out, ", \"phases\": {");
+    for (p = 0; p < PPM_NUM_PHASES; p++) {
+        fprintf(out, "%s\"%s\": {\"min\": %.4f, \"avg\": %.4f, \"max\": %.4f}", p ? ", " : "",
+                ppm_phase_name(p), summary->phase[p].min, summary->phase[p].avg,
+                summary->phase[p].max);
+    }
+    fprintf(out, "}, \"messages\": %.0f, \"bytes_sent\": %.0f",
+            summary->messages.avg * summary->ranks, summary->bytes.avg * summary->ranks);
+    fprintf(out, ", \"machine\": \"%s\", \"commit\": \"%s\", \"timestamp\": \"%s\"}\n", machine,
+            PPM_COMMIT, timestamp);
+}
+
+void ppm_report(MPI_Comm comm, const ppm_run_info_t *info) {
+    ppm_summary_t summary;
+    const char *path;
+    char machine[MPI_MAX_PROCESSOR_NAME];
+    char timestamp[32];
+    time_t now;
+    FILE *out;
+    int rank, nodes, len;
+
+    ppm_instr_summarize(comm, &summary);
+    nodes = ppm_count_nodes(comm);
+
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0) ppm_instr_print(stdout, &summary);
+    ppm_perf_report(comm, stdout);
+    ppm_wait_report(comm, stdout);
+    ppm_trace_write(comm, stdout);
+    if (rank != 0) return;
+
+    path = getenv("PPM_REPORT");
+    if (path == NULL || path[0] == '\0') return;
+
+    if ((out = fopen(path, "a")) == NULL) {
+        fprintf(stderr, "-- Warning: cannot open run report file: %s\n", path);
+        return;
+    }
+    fseek(out, 0, SEEK_END);
+
+    MPI_Get_processor_name(machine, &len);
+    now = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    if (has_suffix(path, ".json")) {
+        write_json(out, info, &summary, nodes, machine, timestamp);
+    } else {
+        write_csv(out, info, &summary, nodes, machine, timestamp);
+    }
+
+    fclose(out);
+}
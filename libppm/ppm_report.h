@@ -0,0 +1,45 @@
+/*
+ * Structured run reports
+ *
+ * At the end of a run the solvers describe what they computed in a ppm_run_info_t and call
+ * ppm_report(). It prints the "Profile:" line of ppm_instr.h (and the "Wait:" lines of
+ * ppm_wait.h with PPM_WAIT=1, the trace of ppm_trace.h with PPM_TRACE) and, when the PPM_REPORT
+ * environment variable names a file, appends one record to it:
+ *
+ *   - *.json: one JSON object per line (JSON Lines)
+ *   - anything else: one CSV row, with the header written when the file is new or empty
+ *
+ * The first CSV columns are the ones of data/output/<variant>_{strong,weak}.csv
+ * (processors, nodes, total_time, comm_time, comp_time, comm_percent); speedup and efficiency
+ * need a baseline run and are left to the benchmark tools.
+ */
+#ifndef PPM_REPORT_H
+#define PPM_REPORT_H
+
+#include <mpi.h>
+
+#include "ppm_instr.h"
+
+/* Commit the binary was built from, injected by the makefiles */
+#ifndef PPM_COMMIT
+#define PPM_COMMIT "unknown"
+#endif
+
+/* What the run computed. Work counters are global (summed over all ranks) */
+typedef struct {
+    const char *variant;  // Solver variant, e.g. "blocking", "nonblocking", "fire"
+    int rows, columns;    // Global grid size
+    int iterations;       // Iterations actually executed
+    double error;         // Final error (Laplace) or global residual (fire simulator)
+    double flops;         // Floating point operations performed by the kernels
+    double bytes;         // Compulsory memory traffic of the kernels
+} ppm_run_info_t;
+
+/* Number of distinct shared-memory nodes spanned by 'comm'. Collective */
+int ppm_count_nodes(MPI_Comm comm);
+
+/* Summarize the instrumentation, print the "Profile:" line on rank 0 and append the run
+ * report to $PPM_REPORT if set. Collective over 'comm' */
+void ppm_report(MPI_Comm comm, const ppm_run_info_t *info);
+
+#endif  // PPM_REPORT_H
@@ -0,0 +1,122 @@
+#include "ppm_slab.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppm_instr.h"
+#include "ppm_topo.h"
+#include "ppm_wait.h"
+
+int ppm_slab_partition(int rows, int size, int rank, int *first_row) {
+    int base = rows / size, extra = rows % size;
+
+    // The first rows % size ranks take one row more
+    if (first_row != NULL) *first_row = rank * base + (rank < extra ? rank : extra);
+    return base + (rank < extra);
+}
+
+void ppm_slab_init(ppm_slab_t *slab, MPI_Comm comm, const ppm_halo_ops_t *halo) {
+    // Slab neighbours as a graph topology so MPI can place rank - 1 and rank + 1 close by
+    slab->comm = ppm_slab_comm(comm);
+    MPI_Comm_rank(slab->comm, &slab->rank);
+    MPI_Comm_size(slab->comm, &slab->size);
+
+    slab->rows = slab->columns = 0;
+    slab->first_row = slab->local_rows = slab->max_local_rows = 0;
+    slab->pitch = 0;
+    slab->grid[0] = slab->grid[1] = NULL;
+    slab->up[0] = slab->up[1] = slab->down[0] = slab->down[1] = NULL;
+    slab->arena = (ppm_arena_t)PPM_ARENA_INIT;
+    slab->halo = halo;
+    slab->halo_state = NULL;
+}
+
+/* Free the grids of the current problem, keeping the arena for the next one */
+static void release_grids(ppm_slab_t *slab) {
+    if (slab->grid[0] != NULL || slab->halo_state != NULL) slab->halo->release(slab);
+    slab->grid[0] = slab->grid[1] = NULL;
+    slab->up[0] = slab->up[1] = slab->down[0] = slab->down[1] = NULL;
+    slab->halo_state = NULL;
+}
+
+int ppm_slab_setup(ppm_slab_t *slab, int rows, int columns) {
+    release_grids(slab);
+
+    if (rows < slab->size) return -1;
+
+    slab->rows = rows;
+    slab->columns = columns;
+    slab->local_rows = ppm_slab_partition(rows, slab->size, slab->rank, &slab->first_row);
+    slab->max_local_rows = ppm_slab_partition(rows, slab->size, 0, NULL);
+    slab->pitch = ppm_pitch(columns, sizeof(real_t));
+
+    if (slab->halo->setup(slab) != 0) {
+        release_grids(slab);
+        return -1;
+    }
+    return 0;
+}
+
+void ppm_slab_publish(ppm_slab_t *slab) {
+    if (slab->halo->sync == NULL) return;
+
+    slab->halo->sync(slab);
+    MPI_Barrier(slab->comm);
+}
+
+void ppm_slab_exchange(ppm_slab_t *slab, real_t *grid) {
+    ppm_phase_begin(PPM_PHASE_HALO);
+    ppm_wait_arrive(PPM_SYNC_HALO, slab->rank, slab->size);
+    slab->halo->exchange(slab, grid);
+    ppm_wait_depart(PPM_SYNC_HALO);
+    ppm_phase_end(PPM_PHASE_HALO);
+}
+
+void ppm_slab_allreduce(ppm_slab_t *slab, void *values, int count, MPI_Datatype type, MPI_Op op) {
+    ppm_phase_begin(PPM_PHASE_REDUCE);
+    ppm_wait_arrive(PPM_SYNC_REDUCE, slab->rank, slab->size);
+    MPI_Allreduce(MPI_IN_PLACE, values, count, type, op, slab->comm);
+    ppm_wait_depart(PPM_SYNC_REDUCE);
+    ppm_phase_end(PPM_PHASE_REDUCE);
+
+    // Every rank wrote its grids before entering the reduction
+    if (slab->halo->sync != NULL) slab->halo->sync(slab);
+}
+
+void ppm_slab_gather(ppm_slab_t *slab, const real_t *grid, real_t *full, int root) {
+    int *counts = NULL, *displs = NULL, r;
+    MPI_Datatype local_rows;
+
+    if (slab->rank == root) {
+        counts = (int *)malloc(sizeof(int) * slab->size);
+        displs = (int *)malloc(sizeof(int) * slab->size);
+        if (counts == NULL || displs == NULL) {
+            fprintf(stderr, "-- Error allocating: gather counts\n");
+            MPI_Abort(slab->comm, EXIT_FAILURE);
+        }
+        for (r = 0; r < slab->size; r++) {
+            counts[r] = ppm_slab_partition(slab->rows, slab->size, r, &displs[r]) * slab->columns;
+            displs[r] *= slab->columns;
+        }
+    }
+
+    // The real rows without their padding, received as contiguous rows on the root
+    MPI_Type_vector(slab->local_rows, slab->columns, (int)slab->pitch, MPI_REAL_T, &local_rows);
+    MPI_Type_commit(&local_rows);
+
+    ppm_phase_begin(PPM_PHASE_GATHER);
+    if (slab->rank != root) ppm_count_message(slab->local_rows * slab->columns, MPI_REAL_T);
+    MPI_Gatherv(&grid[slab->pitch], 1, local_rows, full, counts, displs, MPI_REAL_T, root,
+                slab->comm);
+    ppm_phase_end(PPM_PHASE_GATHER);
+
+    MPI_Type_free(&local_rows);
+    free(counts);
+    free(displs);
+}
+
+void ppm_slab_finalize(ppm_slab_t *slab) {
+    release_grids(slab);
+    ppm_arena_release(&slab->arena);
+    MPI_Comm_free(&slab->comm);
+}
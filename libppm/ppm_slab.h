@@ -0,0 +1,103 @@
+/*
+ * Row-slab decomposition with pluggable halo exchange
+ *
+ * A rows x columns grid is split in horizontal slabs, one per rank of a ppm_slab_comm()
+ * communicator. Rank r owns rows / size rows, one more if r < rows % size, starting at global
+ * row first_row. Every rank stores two grids (grid[0] and grid[1], for double buffering) of
+ * local_rows + 2 rows of 'pitch' elements:
+ *
+ *   row 0                  top halo, a copy of the last real row of rank - 1
+ *   rows 1 .. local_rows   real rows, global rows first_row .. first_row + local_rows - 1
+ *   row local_rows + 1     bottom halo, a copy of the first real row of rank + 1
+ *
+ * The halos of the first and last rank are never written. How halos are filled is up to a
+ * ppm_halo_ops_t strategy, which also allocates the grids because one-sided and shared-memory
+ * exchanges need memory exposed through an MPI window:
+ *
+ *   blocking     MPI_Sendrecv per neighbour, compressed with $PPM_HALO_CODEC (ppm_codec.h)
+ *   nonblocking  MPI_Irecv/MPI_Isend per neighbour + MPI_Waitall
+ *   rma          MPI_Put into the neighbours' halos under post-start-complete-wait
+ *   shm          MPI_Win_allocate_shared per node: on-node neighbour rows are read in place
+ *                through up[]/down[], only off-node halos are exchanged (with MPI_Sendrecv)
+ *
+ * A slab is set up once per communicator and can then hold any number of problems in turn:
+ * ppm_slab_setup() reuses the grid memory when the next problem fits.
+ */
+#ifndef PPM_SLAB_H
+#define PPM_SLAB_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+#include "ppm_grid.h"
+#include "ppm_real.h"
+
+typedef struct ppm_slab ppm_slab_t;
+
+/* Halo exchange strategy */
+typedef struct {
+    const char *name;
+    int in_place;  // Reads on-node neighbour rows through up[]/down[] instead of the halos
+    // Allocate and zero grid[0] and grid[1] for the current decomposition. 0 or -1
+    int (*setup)(ppm_slab_t *slab);
+    // Fill the halo rows of 'grid' (one of grid[0], grid[1]; the same one on all ranks)
+    void (*exchange)(ppm_slab_t *slab, real_t *grid);
+    // Make grid writes visible to the neighbours that read them in place (may be NULL)
+    void (*sync)(ppm_slab_t *slab);
+    // Free what setup() allocated, except the arena
+    void (*release)(ppm_slab_t *slab);
+} ppm_halo_ops_t;
+
+extern const ppm_halo_ops_t ppm_halo_blocking;
+extern const ppm_halo_ops_t ppm_halo_nonblocking;
+extern const ppm_halo_ops_t ppm_halo_rma;
+extern const ppm_halo_ops_t ppm_halo_shm;
+
+struct ppm_slab {
+    MPI_Comm comm;  // Slab communicator, see ppm_topo.h
+    int rank, size;
+    int rows, columns;       // Global grid
+    int first_row;           // Global index of local row 1
+    int local_rows;          // Real rows owned by this rank
+    int max_local_rows;      // Largest local_rows of all ranks
+    size_t pitch;            // Elements per stored row
+    real_t *grid[2];         // Two grids of local_rows + 2 rows
+    const real_t *up[2];     // Row above local row 1 of grid[p] if read in place, else NULL
+    const real_t *down[2];   // Row below local row local_rows of grid[p] if read in place
+    ppm_arena_t arena;       // Grid memory of the strategies that do not use a shared window
+    const ppm_halo_ops_t *halo;
+    void *halo_state;        // Owned by the strategy
+};
+
+/* Strategy called 'name', or NULL */
+const ppm_halo_ops_t *ppm_halo_find(const char *name);
+
+/* Rows owned by 'rank' of 'size' in a grid of 'rows' rows; stores its first global row in
+ * 'first_row' when not NULL */
+int ppm_slab_partition(int rows, int size, int rank, int *first_row);
+
+/* Create the slab communicator of 'comm' and remember the strategy. Collective */
+void ppm_slab_init(ppm_slab_t *slab, MPI_Comm comm, const ppm_halo_ops_t *halo);
+
+/* Decompose a rows x columns grid and allocate both grids, zeroed. Returns -1 if there are
+ * fewer rows than ranks or the grids cannot be allocated. Collective */
+int ppm_slab_setup(ppm_slab_t *slab, int rows, int columns);
+
+/* Call once the initial grids are written, before any rank reads its neighbours. Collective */
+void ppm_slab_publish(ppm_slab_t *slab);
+
+/* Fill the halos of 'grid', timed as the "halo" phase. Collective */
+void ppm_slab_exchange(ppm_slab_t *slab, real_t *grid);
+
+/* In-place MPI_Allreduce of 'count' values, timed as the "reduce" phase. Also orders the grid
+ * writes of all ranks before the reads that follow. Collective */
+void ppm_slab_allreduce(ppm_slab_t *slab, void *values, int count, MPI_Datatype type, MPI_Op op);
+
+/* Gather the real rows of 'grid' into the unpadded rows x columns array 'full' on 'root' (only
+ * read there), timed as the "gather" phase. Collective */
+void ppm_slab_gather(ppm_slab_t *slab, const real_t *grid, real_t *full, int root);
+
+/* Free the grids and the slab communicator. Collective */
+void ppm_slab_finalize(ppm_slab_t *slab);
+
+#endif  // PPM_SLAB_H
@@ -0,0 +1,37 @@
+#include "ppm_stencil.h"
+
+#include <math.h>
+
+void ppm_laplace_boundary(real_t *grid, size_t pitch, int rows, int first_row, int n, int m) {
+    const acc_t exp_PI = exp(-M_PI);
+    acc_t calculation;
+    int i;
+
+    for (i = 0; i < rows; i++) {
+        calculation = ACC_SIN((first_row + i) * M_PI / (n - 1));
+
+        grid[i * pitch + 0] = calculation;
+        grid[i * pitch + m - 1] = exp_PI * calculation;
+    }
+}
+
+acc_t ppm_laplace_sweep(const real_t *A, real_t *Anew, size_t pitch, int begin, int end, int m,
+                        const real_t *up, const real_t *down) {
+    const real_t *north, *south;
+    acc_t error = 0.0, point_error;
+    int i, j;
+
+    for (i = begin; i < end; i++) {
+        north = i == begin && up != NULL ? up : &A[(i - 1) * pitch];
+        south = i == end - 1 && down != NULL ? down : &A[(i + 1) * pitch];
+        for (j = 1; j < m - 1; j++) {
+            Anew[i * pitch + j] =
+                ((acc_t)north[j] + south[j] + A[i * pitch + (j - 1)] + A[i * pitch + (j + 1)]) / 4;
+
+            point_error = ACC_FABS(Anew[i * pitch + j] - A[i * pitch + j]);
+
+            error = ACC_FMAX(error, point_error);
+        }
+    }
+    return error;
+}
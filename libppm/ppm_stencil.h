@@ -0,0 +1,26 @@
+/*
+ * Laplace kernels shared by the sequential and MPI solvers
+ *
+ * The grid holds rows of 'pitch' elements (see ppm_grid.h). The left and right columns of
+ * every row are fixed boundary values sin(r * pi / (n - 1)) and exp(-pi) times that, where r
+ * is the global row; all other values start at zero. One Jacobi sweep replaces every interior
+ * point by the average of its four neighbours. No MPI here, so laplace.c links it on its own.
+ */
+#ifndef PPM_STENCIL_H
+#define PPM_STENCIL_H
+
+#include <stddef.h>
+
+#include "ppm_real.h"
+
+/* Set the boundary columns of 'rows' rows of 'grid', whose first row is global row
+ * 'first_row' of an n x m problem */
+void ppm_laplace_boundary(real_t *grid, size_t pitch, int rows, int first_row, int n, int m);
+
+/* Jacobi sweep of rows [begin, end) of A into Anew, columns 1 to m - 2. 'up' and 'down', when
+ * not NULL, replace rows begin - 1 and end of A (neighbour rows read in place). Returns the
+ * maximum absolute change */
+acc_t ppm_laplace_sweep(const real_t *A, real_t *Anew, size_t pitch, int begin, int end, int m,
+                        const real_t *up, const real_t *down);
+
+#endif  // PPM_STENCIL_H
@@ -0,0 +1,30 @@
+#include "ppm_topo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+MPI_Comm ppm_slab_comm(MPI_Comm comm) {
+    const char *reorder = getenv("PPM_REORDER");
+    int rank, size, degree = 0, neighbours[2], weights[2] = {1, 1};
+    MPI_Comm slab_comm;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    if (rank > 0) neighbours[degree++] = rank - 1;
+    if (rank < size - 1) neighbours[degree++] = rank + 1;
+
+    // Every edge carries one boundary row per iteration in each direction, so the graph is
+    // symmetric and all edges weigh the same
+    MPI_Dist_graph_create_adjacent(comm, degree, neighbours, weights, degree, neighbours, weights,
+                                   MPI_INFO_NULL, reorder == NULL || strcmp(reorder, "0") != 0,
+                                   &slab_comm);
+    return slab_comm;
+}
+
+void ppm_first_touch(void *grid, size_t rows, size_t row_bytes) {
+    long i;
+
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < (long)rows; i++) memset((char *)grid + i * row_bytes, 0, row_bytes);
+}
@@ -0,0 +1,29 @@
+/*
+ * Topology-aware rank placement and first-touch initialization for the row-slab solvers
+ *
+ * The solvers split the grid in horizontal slabs and only talk to rank - 1 and rank + 1.
+ * ppm_slab_comm() declares that chain to MPI as a distributed graph created with reorder=1, so
+ * the library may renumber the ranks to put slab neighbours on the same node and socket
+ * instead of relying on hand-tuned --map-by / --distribution flags. Set PPM_REORDER=0 to keep
+ * the launcher's numbering.
+ *
+ * ppm_first_touch() zeroes freshly allocated grids with the same static row partition as the
+ * compute loops, so on first-touch NUMA systems every page is placed on the memory of the
+ * core (or OpenMP thread) that later updates it. Call it right after allocation and before
+ * any other write.
+ */
+#ifndef PPM_TOPO_H
+#define PPM_TOPO_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+/* Communicator with the ranks of 'comm' arranged as a chain of slab neighbours, possibly
+ * renumbered by MPI. Use it for all communication of the solver and free it with
+ * MPI_Comm_free() before MPI_Finalize(). Collective */
+MPI_Comm ppm_slab_comm(MPI_Comm comm);
+
+/* Zero 'rows' rows of 'row_bytes' bytes in parallel, one static block of rows per thread */
+void ppm_first_touch(void *grid, size_t rows, size_t row_bytes);
+
+#endif  // PPM_TOPO_H
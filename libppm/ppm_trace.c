@@ -0,0 +1,120 @@
+#include "ppm_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_MAX_EVENTS 1000000
+
+/* Longest JSON line of one event */
+#define EVENT_CHARS 160
+
+typedef struct {
+    double begin, end;
+    int phase;
+} event_t;
+
+static const char *path;  // PPM_TRACE, NULL when tracing is off
+static double origin;
+static event_t *events;
+static long long count, capacity, max_events, dropped;
+
+void ppm_trace_init(void) {
+    const char *limit = getenv("PPM_TRACE_EVENTS");
+
+    path = getenv("PPM_TRACE");
+    if (path != NULL && path[0] == '\0') path = NULL;
+    count = dropped = 0;
+    if (path == NULL) return;
+
+    max_events = limit != NULL && atoll(limit) > 0 ? atoll(limit) : DEFAULT_MAX_EVENTS;
+    origin = ppm_common_origin();
+}
+
+void ppm_trace_event(ppm_phase_t phase, double begin, double end) {
+    if (path == NULL) return;
+
+    if (count == capacity) {
+        long long grown = capacity ? 2 * capacity : 16384;
+        event_t *buffer;
+
+        if (grown > max_events) grown = max_events;
+        buffer = grown > capacity ? (event_t *)realloc(events, sizeof(event_t) * grown) : NULL;
+        if (buffer == NULL) {
+            dropped++;
+            return;
+        }
+        events = buffer;
+        capacity = grown;
+    }
+    events[count].begin = begin - origin;
+    events[count].end = end - origin;
+    events[count].phase = phase;
+    count++;
+}
+
+void ppm_trace_write(MPI_Comm comm, FILE *out) {
+    static const char header[] = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    char processor[MPI_MAX_PROCESSOR_NAME];
+    char *text;
+    long long length = 0, offset = 0, totals[2], local[2];
+    MPI_File file;
+    int rank, size, len, rc;
+    long long e;
+
+    if (path == NULL) return;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    MPI_Get_processor_name(processor, &len);
+
+    text = (char *)malloc((size_t)(count + 3) * EVENT_CHARS + sizeof(header) +
+                          MPI_MAX_PROCESSOR_NAME);
+    if (text == NULL) {
+        fprintf(stderr, "-- Error allocating: trace of %lld events\n", count);
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+
+    // Every line but the last one of the last rank ends with a comma
+    if (rank == 0) length += sprintf(text, "%s", header);
+    length += sprintf(text + length,
+                      "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": 0, "
+                      "\"args\": {\"name\": \"rank %d (%s)\"}},\n"
+                      "{\"name\": \"process_sort_index\", \"ph\": \"M\", \"pid\": %d, "
+                      "\"tid\": 0, \"args\": {\"sort_index\": %d}}",
+                      rank, rank, processor, rank, rank);
+    for (e = 0; e < count; e++) {
+        length += sprintf(text + length,
+                          ",\n{\"name\": \"%s\", \"cat\": \"ppm\", \"ph\": \"X\", \"pid\": %d, "
+                          "\"tid\": 0, \"ts\": %.3f, \"dur\": %.3f}",
+                          ppm_phase_name((ppm_phase_t)events[e].phase), rank,
+                          events[e].begin * 1e6, (events[e].end - events[e].begin) * 1e6);
+    }
+    length += sprintf(text + length, rank == size - 1 ? "\n]}\n" : ",\n");
+
+    MPI_Exscan(&length, &offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0) offset = 0;
+
+    rc = MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+    if (rc != MPI_SUCCESS) {
+        if (rank == 0) fprintf(stderr, "-- Warning: cannot open trace file: %s\n", path);
+        free(text);
+        return;
+    }
+    MPI_File_set_size(file, 0);
+    MPI_File_write_at_all(file, offset, text, (int)length, MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_close(&file);
+    free(text);
+
+    local[0] = count;
+    local[1] = dropped;
+    MPI_Reduce(local, totals, 2, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    if (rank == 0) {
+        fprintf(out, "Trace: file=%s ranks=%d events=%lld dropped=%lld\n", path, size, totals[0],
+                totals[1]);
+        if (totals[1] > 0) {
+            fprintf(stderr, "-- Warning: %lld trace events dropped, raise PPM_TRACE_EVENTS\n",
+                    totals[1]);
+        }
+        fflush(out);
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * Built-in event tracing of the solver phases
+ *
+ * With PPM_TRACE=<file> every rank records each phase of ppm_instr.h it times (sweep, halo,
+ * reduce, focal, team, gather, pack) as a complete event, from the timestamps ppm_instr.c takes
+ * anyway, in a buffer of its own. At the end of the run ppm_report() writes all buffers, with one
+ * MPI-IO collective write, to <file> as Chrome trace JSON: one process per rank, which
+ * chrome://tracing and https://ui.perfetto.dev open directly. Timestamps are microseconds from
+ * ppm_common_origin(), so the ranks line up.
+ *
+ * PPM_TRACE_EVENTS caps the events kept per rank (default 1000000, about 24 MB per rank); later
+ * events are dropped and counted.
+ */
+#ifndef PPM_TRACE_H
+#define PPM_TRACE_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+#include "ppm_instr.h"
+
+/* Read PPM_TRACE and, if set, drop the previous events and take the common time origin.
+ * Collective over MPI_COMM_WORLD when set. Called by ppm_instr_init() */
+void ppm_trace_init(void);
+
+/* Record one phase that ran from MPI_Wtime() 'begin' to 'end'. Called by ppm_phase_end() */
+void ppm_trace_event(ppm_phase_t phase, double begin, double end);
+
+/* Write the events of all ranks of 'comm' to the PPM_TRACE file and print a "Trace:" line on
+ * its rank 0. Does nothing unless PPM_TRACE is set. Collective */
+void ppm_trace_write(MPI_Comm comm, FILE *out);
+
+#endif  // PPM_TRACE_H
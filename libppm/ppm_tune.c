@@ -0,0 +1,136 @@
+#include "ppm_tune.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ppm_laplace.h"
+#include "ppm_real.h"
+#include "ppm_report.h"
+
+#define DEFAULT_DB "data/tuning.csv"
+#define DEFAULT_ITER 10
+#define WARMUP_ITER 2
+
+static const ppm_halo_ops_t *candidates[] = {&ppm_halo_blocking, &ppm_halo_nonblocking,
+                                             &ppm_halo_rma, &ppm_halo_shm};
+#define NUM_CANDIDATES ((int)(sizeof(candidates) / sizeof(candidates[0])))
+
+/* Candidate of the last database row for this problem, or -1 */
+static int lookup(const char *path, int n, int m, int size, int nodes, double *seconds) {
+    char line[512], precision[16], halo[16];
+    int rows, columns, processors, row_nodes, found = -1, c;
+    double value;
+    FILE *db = fopen(path, "r");
+
+    if (db == NULL) return -1;
+    while (fgets(line, sizeof(line), db) != NULL) {
+        // The header and malformed rows do not parse
+        if (sscanf(line, "%d,%d,%d,%d,%15[^,],%15[^,],%lf", &rows, &columns, &processors,
+                   &row_nodes, precision, halo, &value) != 7)
+            continue;
+        if (rows != n || columns != m || processors != size || row_nodes != nodes ||
+            strcmp(precision, PPM_PRECISION) != 0)
+            continue;
+        for (c = 0; c < NUM_CANDIDATES; c++) {
+            if (strcmp(candidates[c]->name, halo) == 0) {
+                found = c;
+                *seconds = value;
+            }
+        }
+    }
+    fclose(db);
+    return found;
+}
+
+static void append(const char *path, int n, int m, int size, int nodes, const char *halo,
+                   double seconds) {
+    char timestamp[32];
+    time_t now = time(NULL);
+    FILE *db = fopen(path, "a");
+
+    if (db == NULL) {
+        fprintf(stderr, "-- Warning: cannot open tuning database: %s\n", path);
+        return;
+    }
+    fseek(db, 0, SEEK_END);
+
+    /* New or empty file: write the header first */
+    if (ftell(db) == 0) {
+        fprintf(db, "rows,columns,processors,nodes,precision,halo,seconds_per_iteration,source,"
+                    "timestamp\n");
+    }
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(db, "%d,%d,%d,%d,%s,%s,%.9f,calibration,%s\n", n, m, size, nodes, PPM_PRECISION,
+            halo, seconds, timestamp);
+    fclose(db);
+}
+
+/* Seconds per iteration of the slowest rank with strategy 'halo', or -1 if the problem cannot
+ * be set up with it. Collective */
+static double calibrate(MPI_Comm comm, const ppm_halo_ops_t *halo, int n, int m,
+                        int iterations) {
+    ppm_laplace_t solver;
+    double start = 0.0, seconds = -1.0;
+    int i;
+
+    ppm_laplace_init(&solver, comm, halo);
+    if (ppm_laplace_setup(&solver, n, m) == 0) {
+        for (i = 0; i < WARMUP_ITER + iterations; i++) {
+            if (i == WARMUP_ITER) {
+                MPI_Barrier(comm);
+                start = MPI_Wtime();
+            }
+            ppm_laplace_step(&solver);
+            ppm_laplace_exchange(&solver);
+            ppm_laplace_reduce(&solver);
+        }
+        seconds = (MPI_Wtime() - start) / iterations;
+        MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+    }
+    ppm_laplace_finalize(&solver);
+    return seconds;
+}
+
+const ppm_halo_ops_t *ppm_tune_halo(MPI_Comm comm, int n, int m, FILE *log) {
+    const char *path = getenv("PPM_TUNE_DB"), *env = getenv("PPM_TUNE_ITER");
+    double seconds[NUM_CANDIDATES], cached = 0.0;
+    int iterations = env != NULL && atoi(env) > 0 ? atoi(env) : DEFAULT_ITER;
+    int rank, size, nodes, best = -1, c;
+
+    if (path == NULL) path = DEFAULT_DB;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    nodes = ppm_count_nodes(comm);
+
+    if (rank == 0 && path[0] != '\0') best = lookup(path, n, m, size, nodes, &cached);
+    MPI_Bcast(&best, 1, MPI_INT, 0, comm);
+    if (best >= 0) {
+        if (rank == 0 && log != NULL) {
+            fprintf(log, "Tune: halo=%s source=database seconds_per_iteration=%.6f db=%s\n",
+                    candidates[best]->name, cached, path);
+        }
+        return candidates[best];
+    }
+
+    // Every rank gets the same reduced times, so all pick the same strategy
+    for (c = 0; c < NUM_CANDIDATES; c++) {
+        seconds[c] = calibrate(comm, candidates[c], n, m, iterations);
+        if (seconds[c] >= 0.0 && (best < 0 || seconds[c] < seconds[best])) best = c;
+    }
+    // No strategy fits the problem: the caller's own setup reports why
+    if (best < 0) return candidates[0];
+
+    if (rank == 0) {
+        if (log != NULL) {
+            fprintf(log, "Tune: halo=%s source=calibration iterations=%d", candidates[best]->name,
+                    iterations);
+            for (c = 0; c < NUM_CANDIDATES; c++) {
+                fprintf(log, " %s=%.6f", candidates[c]->name, seconds[c]);
+            }
+            fprintf(log, "\n");
+        }
+        if (path[0] != '\0') append(path, n, m, size, nodes, candidates[best]->name, seconds[best]);
+    }
+    return candidates[best];
+}
@@ -0,0 +1,31 @@
+/*
+ * Auto-tuning of the halo exchange strategy
+ *
+ * Which of the strategies of ppm_slab.h is fastest depends on the grid, the number of ranks,
+ * how they are spread over nodes and the element type. ppm_tune_halo() looks the answer up in
+ * a tuning database and, on a miss, calibrates: every strategy solves the real problem for a
+ * few iterations (PPM_TUNE_ITER, default 10, after 2 warm-up iterations), the slowest rank's
+ * time counts, and the fastest strategy is appended to the database for the next run.
+ *
+ * The database is a CSV file, $PPM_TUNE_DB (default data/tuning.csv; empty to always calibrate
+ * and never write), one row per decision, the last matching row winning:
+ *
+ *   rows,columns,processors,nodes,precision,halo,seconds_per_iteration,source,timestamp
+ *
+ * source is "calibration" for rows written here and "benchmark" for rows written offline by
+ * tools/run_benchmarks.py --tune-db from full benchmark runs.
+ */
+#ifndef PPM_TUNE_H
+#define PPM_TUNE_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+#include "ppm_slab.h"
+
+/* Fastest strategy for an n x m Laplace problem on 'comm', from the database or calibrated.
+ * Prints one "Tune:" line to 'log' on rank 0 if not NULL. Call before ppm_instr_init(), which
+ * drops the phase times of the calibration. Collective */
+const ppm_halo_ops_t *ppm_tune_halo(MPI_Comm comm, int n, int m, FILE *log);
+
+#endif  // PPM_TUNE_H
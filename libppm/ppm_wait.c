@@ -0,0 +1,281 @@
+#include "ppm_wait.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ppm_instr.h"
+
+/* Histogram buckets: [0, 1) us, then [2^(b-1), 2^b) us up to about 16 s */
+#define BUCKETS 26
+
+typedef struct {
+    double arrive, depart;
+    int segment;  // Reductions arrived at before this sync point
+} event_t;
+
+typedef struct {
+    event_t *events;
+    int count, capacity;
+} event_log_t;
+
+static const char *sync_names[PPM_NUM_SYNCS] = {"halo", "reduce"};
+
+static int requested;  // PPM_WAIT is set: ppm_wait_report() takes part in the analysis
+static int recording;  // Timestamps are being recorded (cleared if the log cannot grow)
+static int mixed;      // Sync points of slabs of different ranks or sizes were recorded
+static int slab_rank, slab_size;
+static double origin;
+static event_log_t logs[PPM_NUM_SYNCS];
+
+void ppm_wait_init(void) {
+    const char *env = getenv("PPM_WAIT");
+    int s;
+
+    requested = env != NULL && env[0] != '\0' && strcmp(env, "0") != 0;
+    recording = requested;
+    mixed = 0;
+    slab_rank = slab_size = -1;
+    for (s = 0; s < PPM_NUM_SYNCS; s++) logs[s].count = 0;
+    if (!requested) return;
+
+    origin = ppm_common_origin();
+}
+
+void ppm_wait_arrive(ppm_sync_t sync, int rank, int size) {
+    event_log_t *log = &logs[sync];
+    event_t *event;
+
+    if (!recording) return;
+
+    if (log->count == log->capacity) {
+        int capacity = log->capacity ? 2 * log->capacity : 4096;
+        event_t *events = (event_t *)realloc(log->events, sizeof(event_t) * capacity);
+        if (events == NULL) {
+            fprintf(stderr, "-- Warning: cannot grow the wait-time log, PPM_WAIT disabled\n");
+            recording = 0;
+            return;
+        }
+        log->events = events;
+        log->capacity = capacity;
+    }
+    if (slab_size < 0) {
+        slab_rank = rank;
+        slab_size = size;
+    }
+    mixed |= rank != slab_rank || size != slab_size;
+
+    event = &log->events[log->count++];
+    event->segment = logs[PPM_SYNC_REDUCE].count - (sync == PPM_SYNC_REDUCE);
+    event->arrive = MPI_Wtime() - origin;
+}
+
+void ppm_wait_depart(ppm_sync_t sync) {
+    if (!recording) return;
+    logs[sync].events[logs[sync].count - 1].depart = MPI_Wtime() - origin;
+}
+
+static int bucket(double seconds) {
+    double us = seconds * 1e6;
+    int b;
+
+    if (us < 1.0) return 0;
+    b = 1 + (int)floor(log2(us));
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+static void *alloc_or_abort(MPI_Comm comm, size_t bytes) {
+    void *buffer = malloc(bytes > 0 ? bytes : 1);
+
+    if (buffer == NULL) {
+        fprintf(stderr, "-- Error allocating: wait-time analysis\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    return buffer;
+}
+
+static void print_histogram(FILE *out, ppm_sync_t sync, const long long *hist) {
+    int b;
+
+    fprintf(out, "Wait histogram %s:", sync_names[sync]);
+    for (b = 0; b < BUCKETS; b++) {
+        if (hist[b] == 0) continue;
+        if (b == 0) {
+            fprintf(out, " [0,1)us=%lld", hist[b]);
+        } else {
+            fprintf(out, " [%.0f,%.0f)us=%lld", ldexp(1.0, b - 1), ldexp(1.0, b), hist[b]);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void ppm_wait_report(MPI_Comm comm, FILE *out) {
+    const event_log_t *halo = &logs[PPM_SYNC_HALO], *reduce = &logs[PPM_SYNC_REDUCE];
+    int rank, size, ok, num_halo, num_reduce, k;
+    int check[5];
+    double *first, *last, *up, *down, *values, *halo_wait, *halo_transfer;
+    struct {
+        double value;
+        int rank;
+    } *last_rank, local, slowest, most_last;
+    long long hist[PPM_NUM_SYNCS][BUCKETS], total_hist[PPM_NUM_SYNCS][BUCKETS];
+    // Per rank: reduce wait, reduce transfer, halo wait, halo transfer, compute, end, then the
+    // critical path segments this rank was last in: compute, halo wait, halo transfer, reduce
+    // transfer
+    double mine[10] = {0}, sum[10], max[10];
+    double skew_sum = 0.0, skew_max = 0.0, end = 0.0;
+    int last_count = 0;
+
+    if (!requested) return;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Every rank must have recorded the same sync points as rank 'rank' of one slab over 'comm'
+    ok = recording && !mixed && (slab_size < 0 || (slab_rank == rank && slab_size == size));
+    check[0] = ok;
+    check[1] = halo->count;
+    check[2] = -halo->count;
+    check[3] = reduce->count;
+    check[4] = -reduce->count;
+    MPI_Allreduce(MPI_IN_PLACE, check, 5, MPI_INT, MPI_MIN, comm);
+    if (!check[0] || check[1] != -check[2] || check[3] != -check[4]) {
+        if (rank == 0) {
+            fprintf(out, "Wait: skipped, the ranks did not synchronise as one slab (batch or "
+                         "ensemble groups)\n");
+        }
+        return;
+    }
+    num_halo = halo->count;
+    num_reduce = reduce->count;
+
+    first = (double *)alloc_or_abort(comm, sizeof(double) * num_reduce);
+    last = (double *)alloc_or_abort(comm, sizeof(double) * num_reduce);
+    last_rank = alloc_or_abort(comm, sizeof(*last_rank) * num_reduce);
+    values = (double *)alloc_or_abort(comm, sizeof(double) * (num_halo + num_reduce));
+    up = (double *)alloc_or_abort(comm, sizeof(double) * num_halo);
+    down = (double *)alloc_or_abort(comm, sizeof(double) * num_halo);
+    halo_wait = (double *)calloc(num_reduce + 1, sizeof(double));
+    halo_transfer = (double *)calloc(num_reduce + 1, sizeof(double));
+    if (halo_wait == NULL || halo_transfer == NULL) {
+        fprintf(stderr, "-- Error allocating: wait-time analysis\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+    memset(hist, 0, sizeof(hist));
+
+    // Reductions wait for the last rank to arrive
+    for (k = 0; k < num_reduce; k++) {
+        values[k] = reduce->events[k].arrive;
+        last_rank[k].value = values[k];
+        last_rank[k].rank = rank;
+    }
+    MPI_Allreduce(values, first, num_reduce, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(values, last, num_reduce, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(MPI_IN_PLACE, last_rank, num_reduce, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+
+    // Halo exchanges wait for the later of the two neighbours
+    for (k = 0; k < num_halo; k++) {
+        values[k] = halo->events[k].arrive;
+        up[k] = down[k] = -1.0;
+    }
+    MPI_Sendrecv(values, num_halo, MPI_DOUBLE, rank > 0 ? rank - 1 : MPI_PROC_NULL, 0, down,
+                 num_halo, MPI_DOUBLE, rank < size - 1 ? rank + 1 : MPI_PROC_NULL, 0, comm,
+                 MPI_STATUS_IGNORE);
+    MPI_Sendrecv(values, num_halo, MPI_DOUBLE, rank < size - 1 ? rank + 1 : MPI_PROC_NULL, 1, up,
+                 num_halo, MPI_DOUBLE, rank > 0 ? rank - 1 : MPI_PROC_NULL, 1, comm,
+                 MPI_STATUS_IGNORE);
+
+    for (k = 0; k < num_halo; k++) {
+        const event_t *event = &halo->events[k];
+        double latest = up[k] > down[k] ? up[k] : down[k];
+        double inside = event->depart - event->arrive;
+        double wait = latest > event->arrive ? latest - event->arrive : 0.0;
+        double transfer;
+
+        // Clocks of different nodes may be slightly off: never wait longer than inside
+        if (wait > inside) wait = inside;
+        transfer = inside - wait;
+        mine[2] += wait;
+        mine[3] += transfer;
+        halo_wait[event->segment] += wait;
+        halo_transfer[event->segment] += transfer;
+        hist[PPM_SYNC_HALO][bucket(wait)]++;
+        if (event->depart > end) end = event->depart;
+    }
+
+    for (k = 0; k < num_reduce; k++) {
+        const event_t *event = &reduce->events[k];
+        double inside = event->depart - event->arrive;
+        double wait = last[k] - event->arrive;
+        double transfer;
+        double start = k > 0 ? reduce->events[k - 1].depart : 0.0;
+
+        if (wait > inside) wait = inside;
+        transfer = inside - wait;
+        mine[0] += wait;
+        mine[1] += transfer;
+        hist[PPM_SYNC_REDUCE][bucket(wait)]++;
+        if (event->depart > end) end = event->depart;
+
+        skew_sum += last[k] - first[k];
+        if (last[k] - first[k] > skew_max) skew_max = last[k] - first[k];
+
+        // Segment k of the critical path: this rank held up everybody at reduction k
+        if (last_rank[k].rank == rank) {
+            last_count++;
+            mine[6] += event->arrive - start - halo_wait[k] - halo_transfer[k];
+            mine[7] += halo_wait[k];
+            mine[8] += halo_transfer[k];
+            mine[9] += event->depart - event->arrive;
+        }
+    }
+    mine[4] = end - mine[0] - mine[1] - mine[2] - mine[3];
+    mine[5] = end;
+
+    MPI_Allreduce(mine, sum, 10, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(mine, max, 10, MPI_DOUBLE, MPI_MAX, comm);
+    local.value = mine[4];
+    local.rank = rank;
+    MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+    local.value = last_count;
+    MPI_Allreduce(&local, &most_last, 1, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+    MPI_Reduce(hist, total_hist, PPM_NUM_SYNCS * BUCKETS, MPI_LONG_LONG, MPI_SUM, 0, comm);
+
+    if (rank == 0) {
+        double path = sum[6] + sum[7] + sum[8] + sum[9];
+        double compute_avg = sum[4] / size;
+
+        fprintf(out,
+                "Wait: ranks=%d reduces=%d halos=%d reduce_wait_avg=%.6f reduce_wait_max=%.6f "
+                "reduce_transfer_avg=%.6f halo_wait_avg=%.6f halo_wait_max=%.6f "
+                "halo_transfer_avg=%.6f\n",
+                size, num_reduce, num_halo, sum[0] / size, max[0], sum[1] / size, sum[2] / size,
+                max[2], sum[3] / size);
+        fprintf(out,
+                "Wait: slowest_rank=%d compute_max=%.6f compute_avg=%.6f imbalance=%.3f "
+                "last_rank=%d last_percent=%.1f skew_avg=%.6f skew_max=%.6f\n",
+                slowest.rank, slowest.value, compute_avg,
+                compute_avg > 0.0 ? slowest.value / compute_avg : 0.0, most_last.rank,
+                num_reduce > 0 ? most_last.value / num_reduce * 100 : 0.0,
+                num_reduce > 0 ? skew_sum / num_reduce : 0.0, skew_max);
+        fprintf(out,
+                "Wait: critical_path=%.6f wall=%.6f compute=%.6f halo_wait=%.6f "
+                "halo_transfer=%.6f reduce_transfer=%.6f compute_percent=%.1f "
+                "network_percent=%.1f\n",
+                path, max[5], sum[6], sum[7], sum[8], sum[9],
+                path > 0.0 ? sum[6] / path * 100 : 0.0,
+                path > 0.0 ? (sum[8] + sum[9]) / path * 100 : 0.0);
+        if (num_reduce > 0) print_histogram(out, PPM_SYNC_REDUCE, total_hist[PPM_SYNC_REDUCE]);
+        if (num_halo > 0) print_histogram(out, PPM_SYNC_HALO, total_hist[PPM_SYNC_HALO]);
+        fflush(out);
+    }
+
+    free(first);
+    free(last);
+    free(last_rank);
+    free(values);
+    free(up);
+    free(down);
+    free(halo_wait);
+    free(halo_transfer);
+}
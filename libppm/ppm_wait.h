@@ -0,0 +1,50 @@
+/*
+ * Per-rank wait-time analysis of the synchronisation points
+ *
+ * With PPM_WAIT=1 every rank timestamps its arrival at and departure from each halo exchange
+ * (MPI_Sendrecv, MPI_Isend/MPI_Irecv or MPI_Put, see ppm_halo.c) and each global reduction
+ * (MPI_Allreduce) of ppm_slab.h. At the end of the run the timestamps are matched across ranks:
+ *
+ *   - wait:     time a rank spent inside a sync point before the last rank it depends on arrived
+ *               (all ranks for a reduction, rank - 1 and rank + 1 for a halo exchange). Caused
+ *               by load imbalance
+ *   - transfer: the rest of the time inside the sync point. Network and MPI cost
+ *
+ * and rank 0 prints, next to the "Profile:" line of ppm_instr.h:
+ *
+ *     Wait: ranks=4 reduces=... halos=... reduce_wait_avg=... reduce_transfer_avg=... ...
+ *     Wait: slowest_rank=2 compute_max=... compute_avg=... imbalance=... last_rank=2 ...
+ *     Wait: critical_path=... compute=... halo_wait=... halo_transfer=... reduce_transfer=...
+ *     Wait histogram reduce: [0,1)us=... [1,2)us=... ...
+ *
+ * The critical path follows, between two reductions, the rank that arrived last at the second
+ * one. Timestamps are MPI_Wtime() from ppm_common_origin(), taken at ppm_instr_init(). The
+ * analysis needs every rank in one slab: batch and ensemble runs, whose groups synchronise
+ * separately, are not analysed.
+ */
+#ifndef PPM_WAIT_H
+#define PPM_WAIT_H
+
+#include <mpi.h>
+#include <stdio.h>
+
+/* Synchronisation points of ppm_slab.h */
+typedef enum {
+    PPM_SYNC_HALO,    // ppm_slab_exchange()
+    PPM_SYNC_REDUCE,  // ppm_slab_allreduce()
+    PPM_NUM_SYNCS
+} ppm_sync_t;
+
+/* Read PPM_WAIT and, if set, drop the previous timestamps and take the common time origin.
+ * Collective over MPI_COMM_WORLD when set. Called by ppm_instr_init() */
+void ppm_wait_init(void);
+
+/* Arrival at and departure from a sync point of the slab rank 'rank' of 'size' */
+void ppm_wait_arrive(ppm_sync_t sync, int rank, int size);
+void ppm_wait_depart(ppm_sync_t sync);
+
+/* Match the timestamps across 'comm' and print the "Wait:" lines on its rank 0. Does nothing
+ * unless PPM_WAIT is set. Collective */
+void ppm_wait_report(MPI_Comm comm, FILE *out);
+
+#endif  // PPM_WAIT_H
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""
+Regression Tests
+
+Runs both simulators on small fixed problems and compares their output against the golden
+values in golden.json:
+
+- Laplace: laplace.exe and the blocking, non-blocking, RMA, shared-memory and auto-tuned
+  variants at 1, 2, 3, 4 and 7 ranks. Every `Iteration N -> Error = E` line must be there, with
+  |E - golden| <= --tolerance
+- Fire:    the sequential, OpenMP, MPI (1, 2, 3, 4 and 7 ranks) and hybrid builds. The
+  iteration count of the `Result:` line must match and every value must satisfy
+  |value - golden| <= --fire-tolerance * max(1, |golden|). One of the scenarios is generated by
+  tools/generate_scenario.py and read in binary form
+
+With --perf it also times a few larger runs (best of --repeat, as reported by the programs
+themselves) and fails if any is more than --threshold slower than in baseline.json. The
+baseline is not versioned: --update-baseline records one for this machine (kept only if every
+output test passes), and a baseline of another machine is skipped. --update-golden rewrites
+golden.json from the sequential programs, for changes that alter results on purpose.
+
+Usage:
+    python3 tests/run_tests.py [--suite all|laplace|fire] [--threshold 0.3] [--repeat 5]
+                               [--perf] [--update-golden] [--update-baseline]
+"""
+
+import argparse
+import json
+import os
+import re
+import shlex
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+TESTS_DIR = Path(__file__).resolve().parent
+ROOT = TESTS_DIR.parent
+LAPLACE_DIR = ROOT / "laplace"
+FIRE_DIR = ROOT / "fire-simulator"
+GOLDEN = TESTS_DIR / "golden.json"
+BASELINE = TESTS_DIR / "baseline.json"
+
+RANKS = [1, 2, 3, 4, 7]
+LAPLACE_MPI = [
+    "blocking_laplace", "non_blocking_laplace", "rma_laplace", "shm_laplace", "auto_laplace"
+]
+LAPLACE_TARGETS = ["laplace.exe"] + [f"{name}.exe" for name in LAPLACE_MPI]
+FIRE_TARGETS = [
+    "extinguishing.exe",
+    "parallel_extinguishing.exe",
+    "mpi_extinguishing.exe",
+    "hybrid_extinguishing.exe",
+]
+
+SCENARIOS = FIRE_DIR / "tools" / "ensemble" / "scenarios"
+
+# Problems with golden output: 200 rows do not split evenly over 3 or 7 ranks
+LAPLACE_PROBLEMS = {"laplace_200x300": ["200", "300", "100"]}
+FIRE_PROBLEMS = {
+    # 3 teams and 4 focal points spread over all row slabs
+    "fire_default": (
+        "200 200 300 3 10 10 1 100 190 2 190 100 3 "
+        "4 20 20 0 1000 60 150 5 800 120 40 10 900 180 180 20 700"
+    ).split(),
+    # Every focal point is put out before max_iter: exercises the stop condition
+    "fire_sweep_02": ["-f", str(SCENARIOS / "sweep_02.txt")],
+    # Binary scenario of tools/generate_scenario.py (GENERATED), which the golden output pins too
+    "fire_generated": ["-b", "generated.bin"],
+}
+GENERATED = (
+    "--rows 300 --columns 400 --max-iter 150 --teams 6 --team-mix 2:1:1 --focal 12 "
+    "--layout clusters --clusters 3 --start waves --start-max 40 --seed 3 --format binary"
+).split()
+
+# Timed runs: name -> (suite, executable, ranks, threads, arguments)
+PERF_CASES = {
+    "laplace_seq_1024": ("laplace", "laplace.exe", 0, 1, ["1024", "1024", "300"]),
+    "laplace_blocking_1024_np4": (
+        "laplace", "blocking_laplace.exe", 4, 1, ["1024", "1024", "300"]
+    ),
+    "fire_seq_sweep_01": (
+        "fire", "extinguishing.exe", 0, 1, ["-f", str(SCENARIOS / "sweep_01.txt")]
+    ),
+    "fire_mpi_sweep_01_np4": (
+        "fire", "mpi_extinguishing.exe", 4, 1, ["-f", str(SCENARIOS / "sweep_01.txt")]
+    ),
+}
+
+
+class Runner:
+    def __init__(self, args):
+        self.mpirun = [args.mpirun] + shlex.split(args.mpirun_args)
+
+    def run(self, executable, ranks, threads, arguments):
+        """Run a program (under mpirun when ranks > 0), return (stdout, seconds). The time is
+        the one the program reports (fire `Time:`, the `Profile:` total_max of the MPI
+        programs), or the wall time of the process."""
+        command = [str(executable)] + arguments
+        if ranks > 0:
+            command = self.mpirun + ["-np", str(ranks)] + command
+        env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+        env.pop("PPM_REPORT", None)
+        env["PPM_TUNE_DB"] = ""  # auto_laplace.exe calibrates every time and writes nothing
+        start = time.perf_counter()
+        result = subprocess.run(command, env=env, capture_output=True, text=True)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            print(result.stdout + result.stderr)
+            sys.exit(f"Error: {' '.join(command)} exited with {result.returncode}")
+        reported = re.search(r"^Time: (\S+)$", result.stdout, re.MULTILINE)
+        if reported is None:
+            reported = re.search(r"^Profile: .*total_max=(\S+)", result.stdout, re.MULTILINE)
+        return result.stdout, float(reported.group(1)) if reported else elapsed
+
+
+def laplace_errors(stdout):
+    return [[int(i), float(e)] for i, e in re.findall(r"^Iteration (\d+) -> Error = (\S+)$",
+                                                        stdout, re.MULTILINE)]
+
+
+def fire_result(stdout):
+    match = re.search(r"^Result: (\d+)((?: \S+)*)$", stdout, re.MULTILINE)
+    if match is None:
+        return None
+    return {"iterations": int(match.group(1)), "values": [float(v) for v in match.group(2).split()]}
+
+
+def compare_laplace(errors, golden, tolerance):
+    """Return None if 'errors' matches 'golden', else the reason."""
+    if [i for i, _ in errors] != [i for i, _ in golden]:
+        return f"iterations {[i for i, _ in errors]} instead of {[i for i, _ in golden]}"
+    worst = max((abs(e - g) for (_, e), (_, g) in zip(errors, golden)), default=0.0)
+    return None if worst <= tolerance else f"error off by {worst:.3e} (tolerance {tolerance:g})"
+
+
+def compare_fire(result, golden, tolerance):
+    if result is None:
+        return "no Result: line"
+    if result["iterations"] != golden["iterations"]:
+        return f"{result['iterations']} iterations instead of {golden['iterations']}"
+    if len(result["values"]) != len(golden["values"]):
+        return f"{len(result['values'])} values instead of {len(golden['values'])}"
+    worst = max(
+        (abs(v - g) / max(1.0, abs(g)) for v, g in zip(result["values"], golden["values"])),
+        default=0.0,
+    )
+    return None if worst <= tolerance else f"value off by {worst:.3e} (tolerance {tolerance:g})"
+
+
+def laplace_cases():
+    """(label, executable, ranks, threads) of every Laplace correctness run."""
+    cases = [("laplace", LAPLACE_DIR / "executables" / "laplace.exe", 0, 1)]
+    for name in LAPLACE_MPI:
+        for ranks in RANKS:
+            cases.append((f"{name} np={ranks}", LAPLACE_DIR / "executables" / f"{name}.exe",
+                          ranks, 1))
+    return cases
+
+
+def fire_cases():
+    executables = FIRE_DIR / "executables"
+    cases = [
+        ("extinguishing", executables / "extinguishing.exe", 0, 1),
+        ("parallel_extinguishing threads=3", executables / "parallel_extinguishing.exe", 0, 3),
+    ]
+    for ranks in RANKS:
+        cases.append((f"mpi_extinguishing np={ranks}", executables / "mpi_extinguishing.exe",
+                      ranks, 1))
+    cases.append(("hybrid_extinguishing np=2 threads=2", executables / "hybrid_extinguishing.exe",
+                  2, 2))
+    return cases
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Golden-output and performance regression tests")
+    parser.add_argument("--suite", choices=["all", "laplace", "fire"], default="all")
+    parser.add_argument("--tolerance", type=float, default=1e-5, help="Laplace error tolerance")
+    parser.add_argument(
+        "--fire-tolerance", type=float, default=1e-5, help="Fire Result relative tolerance"
+    )
+    parser.add_argument(
+        "--threshold", type=float, default=0.3, help="Allowed slowdown over the baseline"
+    )
+    parser.add_argument("--repeat", type=int, default=5, help="Runs per timed case, best kept")
+    parser.add_argument("--perf", action="store_true", help="Check the timed runs too")
+    parser.add_argument("--update-golden", action="store_true")
+    parser.add_argument("--update-baseline", action="store_true")
+    parser.add_argument("--mpirun", default="mpirun")
+    parser.add_argument("--mpirun-args", default="--oversubscribe")
+    args = parser.parse_args()
+    if args.repeat < 1:
+        parser.error("--repeat must be at least 1")
+
+    suites = ["laplace", "fire"] if args.suite == "all" else [args.suite]
+    if "laplace" in suites:
+        subprocess.run(["make", "-C", str(LAPLACE_DIR)] + LAPLACE_TARGETS, check=True,
+                       stdout=subprocess.DEVNULL)
+    if "fire" in suites:
+        subprocess.run(["make", "-C", str(FIRE_DIR)] + FIRE_TARGETS, check=True,
+                       stdout=subprocess.DEVNULL)
+
+    runner = Runner(args)
+    golden = json.loads(GOLDEN.read_text()) if GOLDEN.exists() else {}
+    scratch = tempfile.TemporaryDirectory(prefix="ppm_tests_")
+    if "fire" in suites:
+        subprocess.run([sys.executable, str(FIRE_DIR / "tools" / "generate_scenario.py")]
+                       + GENERATED + ["-o", str(Path(scratch.name) / "generated")], check=True,
+                       stdout=subprocess.DEVNULL)
+    failures = 0
+
+    # Correctness: every variant against the golden output of its problem
+    for suite in suites:
+        problems = LAPLACE_PROBLEMS if suite == "laplace" else FIRE_PROBLEMS
+        cases = laplace_cases() if suite == "laplace" else fire_cases()
+        parse = laplace_errors if suite == "laplace" else fire_result
+        for problem, arguments in problems.items():
+            arguments = [str(Path(scratch.name) / a) if a.endswith(".bin") else a
+                         for a in arguments]
+            if args.update_golden:
+                _, executable, ranks, threads = cases[0]
+                golden[problem] = parse(runner.run(executable, ranks, threads, arguments)[0])
+                print(f"golden {problem}: {golden[problem]}")
+            if problem not in golden:
+                sys.exit(f"Error: no golden output for {problem}, run with --update-golden")
+            for label, executable, ranks, threads in cases:
+                output = parse(runner.run(executable, ranks, threads, arguments)[0])
+                if suite == "laplace":
+                    reason = compare_laplace(output, golden[problem], args.tolerance)
+                else:
+                    reason = compare_fire(output, golden[problem], args.fire_tolerance)
+                failures += reason is not None
+                print(f"{'ok' if reason is None else 'FAIL':<5} {problem:<18} {label}"
+                      + ("" if reason is None else f": {reason}"))
+    if args.update_golden:
+        GOLDEN.write_text(json.dumps(golden, indent=2) + "\n")
+
+    # Performance: best time of every timed case against the baseline of this machine
+    if args.perf or args.update_baseline:
+        machine = socket.gethostname()
+        baseline = json.loads(BASELINE.read_text()) if BASELINE.exists() else {}
+        times = {}
+        if not args.update_baseline and baseline.get("machine") != machine:
+            print(f"skip  timing checks: the baseline was recorded on "
+                  f"'{baseline.get('machine', 'no machine')}', this is '{machine}' "
+                  f"(record one with --update-baseline)")
+        else:
+            cases = {name: case for name, case in PERF_CASES.items() if case[0] in suites}
+            # Round-robin over the cases, so that a slow spell of the machine hits one repeat
+            # of several cases rather than every repeat of one
+            for _ in range(args.repeat):
+                for name, (suite, executable, ranks, threads, arguments) in cases.items():
+                    directory = LAPLACE_DIR if suite == "laplace" else FIRE_DIR
+                    seconds = runner.run(directory / "executables" / executable, ranks, threads,
+                                         arguments)[1]
+                    times[name] = min(times.get(name, seconds), seconds)
+            for name in cases:
+                if args.update_baseline:
+                    print(f"time  {name:<28} {times[name]:.4f} s")
+                    continue
+                reference = baseline["times"].get(name)
+                if reference is None:
+                    print(f"skip  {name:<28} {times[name]:.4f} s, no baseline")
+                    continue
+                slower = times[name] / reference - 1.0
+                ok = slower <= args.threshold
+                failures += not ok
+                print(f"{'ok' if ok else 'FAIL':<5} {name:<28} {times[name]:.4f} s, baseline "
+                      f"{reference:.4f} s ({slower * 100:+.1f}%, "
+                      f"limit +{args.threshold * 100:.0f}%)")
+        if args.update_baseline and failures == 0:
+            if baseline.get("machine") != machine:
+                baseline = {"machine": machine, "times": {}}
+            baseline["times"].update({name: round(t, 4) for name, t in times.items()})
+            BASELINE.write_text(json.dumps(baseline, indent=2) + "\n")
+
+    if failures:
+        print(f"\n{failures} test(s) failed")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()